@@ -7,6 +7,10 @@
 #include <cstdint>  // int64_t
 #include <cstddef>  // nullptr_t, ptrdiff_t, size_t
 #include "json_basic.hpp"
+#include "json_tape.hpp"
+#include "json_path.hpp"
+#include "json_snapshot.hpp"
+#include "json_allocator.hpp"
 
 
 namespace sjson
@@ -16,6 +20,19 @@ using json      = detail::basic_json<>;
 using wjson     = detail::str_json<::std::wstring>;     // todo
 using u16json   = detail::str_json<::std::u16string>;   // todo
 using u32json   = detail::str_json<::std::u32string>;   // todo
+using pool_json = detail::basic_json<::std::map, ::std::vector, ::std::string, ::std::int64_t, double, bool, pool_allocator>;
+
+using json_tape         = detail::json_tape<json>;
+using json_tape_view    = detail::json_tape_view<json>;
+using json_pointer      = detail::json_pointer<json>;
+using json_path         = detail::json_path<json>;
+using json_snapshot     = detail::json_snapshot<json>;
+using string_view       = detail::basic_string_view<char>;
+using json_memory_usage = detail::json_memory_usage;
+using json_allocation_stats = detail::json_allocation_stats;
+
+template<typename Ty>
+using span              = detail::json_span<Ty>;
 
 
 
@@ -44,7 +61,7 @@ struct hash<::sjson::json>
 {
     std::size_t operator()(const ::sjson::json& json)const 
     {
-        return std::hash<::sjson::json::string_t>()(json.dump());
+        return json.hash();
     }
 };
 
@@ -0,0 +1,299 @@
+#ifndef JSON_ALLOCATOR_HPP
+#define JSON_ALLOCATOR_HPP
+
+#include <atomic>   // atomic
+#include <cstddef>  // size_t
+#include <cstdint>  // uintptr_t
+#include <new>      // operator new, operator delete
+#include <mutex>    // mutex, lock_guard
+#include <vector>   // vector
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// node_pool, size-class free lists for the small fixed-size blocks of json nodes
+// every thread allocates from and frees into its own lists without locking.
+// blocks are carved from chunks aligned to chunk_size, whose header names the
+// lists that own them: a block freed on another thread, such as by
+// json_release_queue, is pushed onto the atomic remote list of its owner, and
+// the owner takes those back when its own list of that size runs out. the
+// lists of an exiting thread are adopted by the next thread that starts
+//
+class node_pool
+{
+public:
+    static constexpr std::size_t granularity    = 16;
+    static constexpr std::size_t class_count    = 16;
+    static constexpr std::size_t max_block_size = granularity * class_count;
+    static constexpr std::size_t chunk_size     = 64 * 1024;
+    static constexpr std::size_t slab_chunks    = 16;
+
+public:
+    static void* allocate(std::size_t size)
+    {
+        if (size == 0 || size > max_block_size)
+        {
+            return ::operator new(size);
+        }
+        return local().pop(size_class(size));
+    }
+
+    // the bytes handed out for a request of size
+    static std::size_t block_size(std::size_t size)noexcept
+    {
+        if (size == 0 || size > max_block_size)
+        {
+            return size;
+        }
+        return (size_class(size) + 1) * granularity;
+    }
+
+    static void deallocate(void* ptr, std::size_t size)noexcept
+    {
+        if (size == 0 || size > max_block_size)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto& lists = local();
+        const auto owner = chunk_of(ptr)->owner;
+        if (owner == &lists)
+        {
+            lists.push(size_class(size), ptr);
+        }
+        else
+        {
+            owner->push_remote(size_class(size), ptr);
+        }
+    }
+
+    // the chunks carved so far, every thread together
+    static std::size_t chunk_count()
+    {
+        auto& reg = shared();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        return reg.chunk_count;
+    }
+
+
+private:
+    struct free_block
+    {
+        free_block* next;
+    };
+
+    struct free_lists
+    {
+        free_block*                 heads[class_count] = {};
+        std::atomic<free_block*>    remote[class_count];
+
+        free_lists()noexcept
+        {
+            for (auto& head : remote)
+            {
+                head.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        void* pop(std::size_t index)
+        {
+            if (heads[index] == nullptr)
+            {
+                refill(index);
+            }
+            auto block = heads[index];
+            heads[index] = block->next;
+            return block;
+        }
+
+        void push(std::size_t index, void* ptr)noexcept
+        {
+            auto block = static_cast<free_block*>(ptr);
+            block->next = heads[index];
+            heads[index] = block;
+        }
+
+        // from any thread, the owner takes the whole list at once so there is no ABA
+        void push_remote(std::size_t index, void* ptr)noexcept
+        {
+            auto block = static_cast<free_block*>(ptr);
+            block->next = remote[index].load(std::memory_order_relaxed);
+            while (!remote[index].compare_exchange_weak(block->next, block,
+                std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void refill(std::size_t index)
+        {
+            heads[index] = remote[index].exchange(nullptr, std::memory_order_acquire);
+            if (heads[index] != nullptr)
+            {
+                return;
+            }
+
+            const std::size_t block_size = (index + 1) * granularity;
+            auto chunk = shared().new_chunk();
+            reinterpret_cast<chunk_header*>(chunk)->owner = this;
+
+            for (std::size_t offset = chunk_size / block_size * block_size; offset >= header_size + block_size; offset -= block_size)
+            {
+                push(index, chunk + offset - block_size);
+            }
+        }
+    };
+
+    struct chunk_header
+    {
+        free_lists* owner;
+    };
+
+    // blocks start after the header, still aligned to granularity
+    static constexpr std::size_t header_size = granularity;
+    static_assert(sizeof(chunk_header) <= header_size, "the chunk header must fit before the first block");
+
+    // chunks and lists are never given back, blocks may outlive the thread that carved them
+    struct registry
+    {
+        std::mutex                  mutex;
+        std::vector<void*>          slabs;
+        char*                       next_chunk  = nullptr;
+        char*                       slab_end    = nullptr;
+        std::size_t                 chunk_count = 0;
+        std::vector<free_lists*>    idle;
+        std::size_t                 list_count  = 0;
+
+        // slab_chunks aligned chunks are cut from each slab
+        char* new_chunk()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (next_chunk == slab_end)
+            {
+                slabs.reserve(slabs.size() + 1);
+                auto slab = static_cast<char*>(::operator new((slab_chunks + 1) * chunk_size));
+                slabs.push_back(slab);
+
+                const auto address = reinterpret_cast<std::uintptr_t>(slab);
+                next_chunk = slab + ((chunk_size - address % chunk_size) % chunk_size);
+                slab_end = next_chunk + slab_chunks * chunk_size;
+            }
+
+            auto chunk = next_chunk;
+            next_chunk += chunk_size;
+            ++chunk_count;
+            return chunk;
+        }
+
+        free_lists* adopt()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!idle.empty())
+            {
+                auto lists = idle.back();
+                idle.pop_back();
+                return lists;
+            }
+
+            // room for every list, so abandon() does not allocate
+            idle.reserve(list_count + 1);
+            auto lists = new free_lists;
+            ++list_count;
+            return lists;
+        }
+
+        void abandon(free_lists* lists)noexcept
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(lists);
+        }
+    };
+
+    // the lists of this thread, handed back to the registry when it exits
+    struct local_lists
+    {
+        free_lists* lists;
+
+        local_lists() : lists(shared().adopt()) { }
+
+        ~local_lists()
+        {
+            shared().abandon(lists);
+        }
+    };
+
+    static std::size_t size_class(std::size_t size)noexcept
+    {
+        return (size - 1) / granularity;
+    }
+
+    static chunk_header* chunk_of(void* ptr)noexcept
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        return reinterpret_cast<chunk_header*>(address - address % chunk_size);
+    }
+
+    static registry& shared()
+    {
+        // intentionally never destroyed, threads may exit after static destruction
+        static registry* reg = new registry;
+        return *reg;
+    }
+
+    static free_lists& local()
+    {
+        static thread_local local_lists holder;
+        return *holder.lists;
+    }
+};
+
+
+} // namespace detail
+
+
+
+//
+// pool_allocator, an allocator policy for basic_json that serves node blocks
+// from thread-local size-class pools instead of the global heap
+//
+template<typename Ty>
+class pool_allocator
+{
+public:
+    using value_type = Ty;
+
+public:
+    pool_allocator()noexcept = default;
+
+    template<typename Other>
+    pool_allocator(const pool_allocator<Other>&)noexcept { }
+
+    Ty* allocate(std::size_t count)
+    {
+        return static_cast<Ty*>(detail::node_pool::allocate(count * sizeof(Ty)));
+    }
+
+    void deallocate(Ty* ptr, std::size_t count)noexcept
+    {
+        detail::node_pool::deallocate(ptr, count * sizeof(Ty));
+    }
+
+    // the bytes of a block of size, rounded up to its size class
+    static std::size_t block_size(std::size_t size)noexcept
+    {
+        return detail::node_pool::block_size(size);
+    }
+
+    friend bool operator==(const pool_allocator&, const pool_allocator&)noexcept { return true;  }
+    friend bool operator!=(const pool_allocator&, const pool_allocator&)noexcept { return false; }
+};
+
+
+} // namespace sjson
+
+#endif // JSON_ALLOCATOR_HPP
@@ -0,0 +1,214 @@
+#ifndef JSON_ATOM_HPP
+#define JSON_ATOM_HPP
+
+#include <cstddef>          // size_t
+#include <functional>       // hash
+#include <mutex>            // mutex, lock_guard
+#include <ostream>          // basic_ostream
+#include <unordered_set>    // unordered_set
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_atom_table, the process-wide set of interned object keys
+// an interned string is never freed, so a pointer to it names the key for
+// the lifetime of the process; each thread keeps a lock-free cache in front
+//
+template<typename StringType>
+class json_atom_table
+{
+public:
+    static const StringType* intern(const StringType& str)
+    {
+        auto& cache = local();
+        auto iter = cache.find(&str);
+        if (iter != cache.end())
+        {
+            return *iter;
+        }
+
+        const StringType* atom = nullptr;
+        {
+            auto& table = shared();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            atom = &*table.strings.insert(str).first;
+        }
+        cache.insert(atom);
+        return atom;
+    }
+
+    // the interned copy of str, or null if str was never interned
+    static const StringType* lookup(const StringType& str)
+    {
+        auto& cache = local();
+        auto iter = cache.find(&str);
+        if (iter != cache.end())
+        {
+            return *iter;
+        }
+
+        const StringType* atom = nullptr;
+        {
+            auto& table = shared();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            auto found = table.strings.find(str);
+            if (found == table.strings.end())
+            {
+                return nullptr;
+            }
+            atom = &*found;
+        }
+        cache.insert(atom);
+        return atom;
+    }
+
+    static std::size_t size()
+    {
+        auto& table = shared();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        return table.strings.size();
+    }
+
+
+private:
+    struct shared_table
+    {
+        std::mutex                      mutex;
+        std::unordered_set<StringType>  strings;
+    };
+
+    struct content_hash
+    {
+        std::size_t operator()(const StringType* str)const { return std::hash<StringType>()(*str); }
+    };
+
+    struct content_equal
+    {
+        bool operator()(const StringType* lhs, const StringType* rhs)const { return *lhs == *rhs; }
+    };
+
+    using local_cache = std::unordered_set<const StringType*, content_hash, content_equal>;
+
+    static shared_table& shared()
+    {
+        // intentionally never destroyed, atoms may be used during static destruction
+        static shared_table* table = new shared_table;
+        return *table;
+    }
+
+    static local_cache& local()
+    {
+        static thread_local local_cache cache;
+        return cache;
+    }
+};
+
+
+
+//
+// json_atom, an interned object key: equal keys share one string, so key
+// equality is a pointer compare and every document shares the key memory.
+// atoms order by their text, so objects keep iterating in key order
+//
+template<typename StringType>
+class json_atom
+{
+public:
+    using string_type   = StringType;
+    using char_type     = typename StringType::value_type;
+    using table_type    = json_atom_table<StringType>;
+
+public:
+    json_atom() : m_str(empty_atom()) { }
+
+    json_atom(const StringType& str) : m_str(table_type::intern(str)) { }
+
+    json_atom(const char_type* str) : m_str(table_type::intern(StringType(str))) { }
+
+    // the atom of str without interning it, false if str was never interned
+    // and so is the key of no object
+    static bool find(const StringType& str, json_atom& atom)
+    {
+        const StringType* interned = table_type::lookup(str);
+        if (interned == nullptr)
+        {
+            return false;
+        }
+        atom.m_str = interned;
+        return true;
+    }
+
+    operator const StringType&()const noexcept  { return *m_str;    }
+
+    const StringType& str()const noexcept       { return *m_str;    }
+
+    std::size_t size()const noexcept            { return m_str->size();     }
+
+    bool empty()const noexcept                  { return m_str->empty();    }
+
+
+public:
+    friend bool operator==(const json_atom& lhs, const json_atom& rhs)noexcept  { return lhs.m_str == rhs.m_str; }
+    friend bool operator!=(const json_atom& lhs, const json_atom& rhs)noexcept  { return lhs.m_str != rhs.m_str; }
+
+    friend bool operator==(const json_atom& lhs, const StringType& rhs)         { return *lhs.m_str == rhs; }
+    friend bool operator==(const StringType& lhs, const json_atom& rhs)         { return lhs == *rhs.m_str; }
+    friend bool operator!=(const json_atom& lhs, const StringType& rhs)         { return *lhs.m_str != rhs; }
+    friend bool operator!=(const StringType& lhs, const json_atom& rhs)         { return lhs != *rhs.m_str; }
+
+    friend bool operator==(const json_atom& lhs, const char_type* rhs)          { return *lhs.m_str == rhs; }
+    friend bool operator==(const char_type* lhs, const json_atom& rhs)          { return lhs == *rhs.m_str; }
+    friend bool operator!=(const json_atom& lhs, const char_type* rhs)          { return *lhs.m_str != rhs; }
+    friend bool operator!=(const char_type* lhs, const json_atom& rhs)          { return lhs != *rhs.m_str; }
+
+    friend bool operator<(const json_atom& lhs, const json_atom& rhs)
+    {
+        return lhs.m_str != rhs.m_str && *lhs.m_str < *rhs.m_str;
+    }
+
+    friend std::basic_ostream<char_type>& operator<<(std::basic_ostream<char_type>& os, const json_atom& atom)
+    {
+        return os << *atom.m_str;
+    }
+
+
+private:
+    static const StringType* empty_atom()
+    {
+        static const StringType* atom = table_type::intern(StringType());
+        return atom;
+    }
+
+    const StringType* m_str;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+
+
+namespace std
+{
+
+//
+// hash<json_atom>, for unordered object types. equal atoms share one string
+//
+template<typename StringType>
+struct hash<::sjson::detail::json_atom<StringType>>
+{
+    std::size_t operator()(const ::sjson::detail::json_atom<StringType>& atom)const noexcept
+    {
+        return std::hash<const StringType*>()(&atom.str());
+    }
+};
+
+} // namespace std
+
+#endif // JSON_ATOM_HPP
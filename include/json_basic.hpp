@@ -5,12 +5,21 @@
 #include <algorithm>
 #include <iterator>
 #include <utility>
+#include <tuple>
 #include <initializer_list>
+#include <limits>
 #include "json_utils.hpp"
 #include "json_value.hpp"
+#include "json_packed.hpp"
 #include "json_parser.hpp"
 #include "json_iterator.hpp"
 #include "json_serializer.hpp"
+#include "json_release.hpp"
+#include "json_atom.hpp"
+#include "json_string_view.hpp"
+#include "json_pointer.hpp"
+#include "json_patch.hpp"
+#include "json_builder.hpp"
 #include "json_exception.hpp"
 
 namespace sjson
@@ -27,6 +36,8 @@ public:
     friend class iterator_impl<basic_json>;
     friend class iterator_impl<const basic_json>;
     friend class json_parser<basic_json>;
+    friend class json_dom_builder<basic_json>;
+    friend class json_value<basic_json>;
 
     
 public:
@@ -40,16 +51,35 @@ public:
 
     using iterator                  = iterator_impl<basic_json>;
     using const_iterator            = iterator_impl<const basic_json>;
-    using reverse_iterator          = std::reverse_iterator<iterator>;
-    using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
+    using reverse_iterator          = json_reverse_iterator<iterator>;
+    using const_reverse_iterator    = json_reverse_iterator<const_iterator>;
 
 public:
-    using object_t                  = ObjectType<StringType, basic_json>;
+#if defined(SJSON_ATOM_KEYS)
+    using key_t                     = json_atom<StringType>;
+#else
+    using key_t                     = StringType;
+#endif
+    using object_t                  = typename json_object_type<ObjectType, key_t, basic_json, StringType>::type;
     using array_t                   = ArrayType<basic_json>;
     using string_t                  = StringType;
     using number_integer_t          = NumberIntegerType;
+    using number_unsigned_t         = typename std::make_unsigned<NumberIntegerType>::type;
+    using number_big_integer_t      = json_big_integer<StringType>;
     using number_float_t            = NumberFloatType;
     using boolean_t                 = BooleanType;
+    using string_view_t             = basic_string_view<char_type>;
+    using allocator_type            = AllocatorType<basic_json>;
+    using json_pointer_t            = json_pointer<basic_json>;
+    using object_builder            = json_object_builder<basic_json>;
+    using array_builder             = json_array_builder<basic_json>;
+
+private:
+    // a key type other than key_t that can be looked up as a string_view_t
+    template<typename KeyType>
+    using enable_if_key_view = typename std::enable_if<
+        std::is_convertible<const KeyType&, string_view_t>::value &&
+        !std::is_same<KeyType, key_t>::value, int>::type;
 
 
 public:
@@ -102,16 +132,25 @@ public:
 
     basic_json(const number_integer_t num): m_value(num) { }
 
+    basic_json(const number_big_integer_t& num): m_value(num) { }
+
+    basic_json(number_big_integer_t&& num): m_value(std::move(num)) { }
+
     basic_json(const number_float_t num): m_value(num) { }
 
     basic_json(const boolean_t val): m_value(val) { }
 
 
     template<typename Integer, 
-            typename std::enable_if<std::is_integral<Integer>::value, int>::type = 0>
+            typename std::enable_if<std::is_integral<Integer>::value && std::is_signed<Integer>::value, int>::type = 0>
     basic_json(const Integer num): m_value(static_cast<number_integer_t>(num)) { }
 
 
+    template<typename Integer, 
+            typename std::enable_if<std::is_integral<Integer>::value && std::is_unsigned<Integer>::value, int>::type = 0>
+    basic_json(const Integer num): m_value(static_cast<number_unsigned_t>(num)) { }
+
+
     template<typename Floating,
             typename std::enable_if<std::is_floating_point<Floating>::value, int>::type = 0>
     basic_json(const Floating num): m_value(static_cast<number_float_t>(num)) { }
@@ -128,7 +167,7 @@ public:
             m_value = json_value<basic_json>(value_t::object);
             for (const basic_json& json : init_list)
             {
-                m_value.m_data.object->emplace(std::move(*(json[0].m_value.m_data.string)), std::move(json[1]));
+                m_value.modify_object().emplace(json[0].m_value.string_value(), json[1]);
             }
         }
         else
@@ -154,8 +193,7 @@ public:
         }
 
         basic_json obj(value_t::object);
-        obj.m_value.m_data.object->emplace( std::move(*(init_list.begin()->m_value.m_data.string)), 
-                                            std::move(*(init_list.begin() + 1)));
+        obj.m_value.modify_object().emplace(init_list.begin()->m_value.string_value(), *(init_list.begin() + 1));
         return obj;
     }
 
@@ -164,34 +202,56 @@ public:
         basic_json arr(value_t::array);
         if (init_list.size())
         {
-            arr.m_value.m_data.array->reserve(init_list.size());
-            arr.m_value.m_data.array->assign(init_list.begin(), init_list.end());
+            arr.m_value.modify_array().reserve(init_list.size());
+            arr.m_value.modify_array().assign(init_list.begin(), init_list.end());
         }
         return arr;
     }
 
+    // make_object("id", 1, "tags", make_array("a", "b")) builds every value in
+    // place and moves the nested ones, an initializer_list copies them all
+    template<typename... Args>
+    static basic_json make_object(Args&&... args)
+    {
+        static_assert(sizeof...(Args) % 2 == 0, "make_object takes a value for every key");
+        return object_builder(sizeof...(Args) / 2).emplace_pairs(std::forward<Args>(args)...).build();
+    }
+
+    template<typename... Args>
+    static basic_json make_array(Args&&... args)
+    {
+        return array_builder(sizeof...(Args)).emplace_all(std::forward<Args>(args)...).build();
+    }
+
 
 public:
-    bool is_null()const noexcept    { return m_value.m_type == value_t::null;           }
+    bool is_null()const noexcept    { return type() == value_t::null;           }
 
-    bool is_object()const noexcept  { return m_value.m_type == value_t::object;         }
+    bool is_object()const noexcept  { return type() == value_t::object;         }
 
-    bool is_array()const noexcept   { return m_value.m_type == value_t::array;          }
+    bool is_array()const noexcept   { return type() == value_t::array;          }
     
-    bool is_string()const noexcept  { return m_value.m_type == value_t::string;         }
+    bool is_string()const noexcept  { return type() == value_t::string;         }
 
-    bool is_integer()const noexcept { return m_value.m_type == value_t::number_integer; }
+    // number_integer or number_unsigned, both fit in 64 bits
+    bool is_integer()const noexcept { return type() == value_t::number_integer || is_unsigned(); }
 
-    bool is_float()const noexcept   { return m_value.m_type == value_t::number_float;   }
+    bool is_unsigned()const noexcept    { return type() == value_t::number_unsigned;    }
 
-    bool is_number()const noexcept  { return is_integer() || is_float();                }
+    bool is_big_integer()const noexcept { return type() == value_t::number_big_integer; }
 
-    bool is_bool()const noexcept    { return m_value.m_type == value_t::boolean;        }
+    bool is_float()const noexcept   { return type() == value_t::number_float;   }
+
+    bool is_number()const noexcept  { return is_integer() || is_big_integer() || is_float(); }
+
+    bool is_bool()const noexcept    { return type() == value_t::boolean;        }
+
+    bool is_packed()const noexcept  { return m_value.is_packed();               }
 
     
     value_t type()const noexcept
     {
-        return m_value.m_type;
+        return m_value.type();
     }
 
     string_t type_name()const noexcept
@@ -211,6 +271,8 @@ public:
                 return string_t("string");
 
             case value_t::number_integer:
+            case value_t::number_unsigned:
+            case value_t::number_big_integer:
             case value_t::number_float:
                 return string_t("number");
 
@@ -284,7 +346,7 @@ public:
 
     reverse_iterator rend()
     {
-        reverse_iterator(being());
+        return reverse_iterator(begin());
     }
 
     const_reverse_iterator rend()const
@@ -307,13 +369,17 @@ public:
                 return 0;
 
             case value_t::object:
-                return m_value.m_data.object->size();
+                return m_value.object_value().size();
 
             case value_t::array:
-                return m_value.m_data.array->size();
+                if (m_value.is_packed())
+                {
+                    return m_value.packed_value().size();
+                }
+                return m_value.array_value().size();
 
             case value_t::string:
-                return m_value.m_data.string->size();
+                return m_value.string_value().size();
 
             default:
                 return 1;
@@ -325,6 +391,87 @@ public:
         return size() == 0;
     }
 
+    // the heap bytes held by the document, see json_memory_usage
+    json_memory_usage memory_usage()const
+    {
+        return m_value.memory_usage();
+    }
+
+    // capacity of an array, or of an object when object_t has one.
+    // a null becomes an array, like push_back()
+    void reserve(const size_type count)
+    {
+        if (is_null())
+        {
+            m_value = json_value<basic_json>(value_t::array);
+        }
+
+        switch (type())
+        {
+            case value_t::object:
+                reserve_container(m_value.modify_object(), count);
+                break;
+
+            case value_t::array:
+                if (m_value.is_packed())
+                {
+                    m_value.modify_packed().reserve(count);
+                }
+                else
+                {
+                    reserve_container(m_value.modify_array(), count);
+                }
+                break;
+
+            default:
+                throw json_type_error("reserve() cannot be called by a non-container type");
+        }
+    }
+
+    // the size of an object_t without capacity, such as std::map
+    size_type capacity()const noexcept
+    {
+        switch (type())
+        {
+            case value_t::object:
+                return capacity_of(m_value.object_value());
+
+            case value_t::array:
+                if (m_value.is_packed())
+                {
+                    return m_value.packed_value().capacity();
+                }
+                return capacity_of(m_value.array_value());
+
+            default:
+                return size();
+        }
+    }
+
+    void shrink_to_fit()
+    {
+        switch (type())
+        {
+            case value_t::object:
+                shrink_container(m_value.modify_object());
+                break;
+
+            case value_t::array:
+                if (m_value.is_packed())
+                {
+                    m_value.modify_packed().shrink_to_fit();
+                }
+                else
+                {
+                    shrink_container(m_value.modify_array());
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
 
 public:
     const_iterator find(const typename object_t::key_type& key)const
@@ -332,7 +479,7 @@ public:
         if (is_object())
         {
             const_iterator iter(this);
-            iter.m_iter.object_iter = m_value.m_data.object->find(key);
+            iter.m_iter.object_iter = m_value.object_value().find(key);
             return iter;
         }
 
@@ -344,6 +491,27 @@ public:
         return find(key) != cend();
     }
 
+    // find(), contains(), erase(), operator[] and at() also take a key as a
+    // const char*, a string view or anything else convertible to string_view_t
+    template<typename KeyType, enable_if_key_view<KeyType> = 0>
+    const_iterator find(const KeyType& key)const
+    {
+        if (is_object())
+        {
+            const_iterator iter(this);
+            iter.m_iter.object_iter = find_key(m_value.object_value(), key);
+            return iter;
+        }
+
+        return cend();
+    }
+
+    template<typename KeyType, enable_if_key_view<KeyType> = 0>
+    bool contains(const KeyType& key)const
+    {
+        return find(key) != cend();
+    }
+
     std::pair<iterator, bool> insert(const typename object_t::value_type& obj)
     {
         std::pair<iterator, bool> result(end(), false);
@@ -358,7 +526,7 @@ public:
             return result;
     }
 
-        std::tie(result.first.m_iter.object_iter, result.second) = m_value.m_data.object->insert(obj);
+        std::tie(result.first.m_iter.object_iter, result.second) = m_value.object_value().insert(obj);
         return result;
     }
 
@@ -376,7 +544,29 @@ public:
             return result;
         }
 
-        std::tie(result.first.m_iter.object_iter, result.second) = m_value.m_data.object->insert(std::move(obj));
+        std::tie(result.first.m_iter.object_iter, result.second) = m_value.object_value().insert(std::move(obj));
+        return result;
+    }
+
+    // only for object, the value is constructed from args in place,
+    // an existing key keeps its value
+    template<typename KeyType, typename... Args>
+    std::pair<iterator, bool> emplace(KeyType&& key, Args&&... args)
+    {
+        std::pair<iterator, bool> result(end(), false);
+
+        if (is_null())
+        {
+            m_value = json_value<basic_json>(value_t::object);
+        }
+
+        if (!is_object())
+        {
+            return result;
+        }
+
+        std::tie(result.first.m_iter.object_iter, result.second) = m_value.object_value().emplace(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<KeyType>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
         return result;
     }
 
@@ -391,14 +581,33 @@ public:
         return insert(std::make_pair(std::move(key), std::move(val)));
     }
 
-    iterator erase(const typename object_t::key_type& key)
+    size_type erase(const typename object_t::key_type& key)
     {
         if (!is_object())
         {
-            return end();
+            return 0;
         }
 
-        return m_value.m_data.object->erase(key);
+        return m_value.modify_object().erase(key);
+    }
+
+    template<typename KeyType, enable_if_key_view<KeyType> = 0>
+    size_type erase(const KeyType& key)
+    {
+        if (!is_object())
+        {
+            return 0;
+        }
+
+        auto& object = m_value.modify_object();
+        const auto iter = find_key(object, key);
+        if (iter == object.end())
+        {
+            return 0;
+        }
+
+        object.erase(iter);
+        return 1;
     }
 
     iterator erase(const_iterator iter)
@@ -408,13 +617,31 @@ public:
             return end();
         }
 
+        const auto& origin = static_cast<const json_value<basic_json>&>(m_value).object_value();
+        auto& object = m_value.object_value();
+
         iterator res(this);
-        res.m_iter.object_iter = m_value.m_data.object->erase(iter.m_iter.object_iter);
+        if (&origin != &object)
+        {
+            // the object was shared and has been detached, iter points into the old copy
+            res.m_iter.object_iter = object.erase(object.find(iter.key()));
+        }
+        else
+        {
+            res.m_iter.object_iter = object.erase(iter.m_iter.object_iter);
+        }
         return res;
     }
 
     // only for array
     void push_back(const basic_json& json)
+    {
+        // copy first, json may be this array or one of its elements
+        push_back(basic_json(json));
+    }
+
+    // only for array
+    void push_back(basic_json&& json)
     {
         if (is_null())
         {
@@ -426,23 +653,30 @@ public:
             throw json_type_error("push_back() cannot be called by a non-array type");
         }
 
-        m_value.m_data.array->emplace_back(json);
+        if (!m_value.push_packed(json.m_value))
+        {
+            m_value.modify_array().emplace_back(std::move(json));
+        }
     }
 
-    // only for array
-    void push_back(basic_json&& json)
+    // only for array, the element is constructed from args in place.
+    // a packed array is unpacked, the result is a reference to the element
+    template<typename... Args>
+    basic_json& emplace_back(Args&&... args)
     {
         if (is_null())
         {
             m_value = json_value<basic_json>(value_t::array);
         }
-        
+
         if (!is_array())
         {
-            throw json_type_error("push_back() cannot be called by a non-array type");
+            throw json_type_error("emplace_back() cannot be called by a non-array type");
         }
 
-        m_value.m_data.array->emplace_back(std::move(json));
+        auto& array = m_value.array_value();
+        array.emplace_back(std::forward<Args>(args)...);
+        return array.back();
     }
 
     // only for array
@@ -453,7 +687,14 @@ public:
             throw json_type_error("pop_back() cannot be called by a non-array type");
         }
 
-        m_value.m_data.array->pop_back();
+        if (m_value.is_packed())
+        {
+            m_value.modify_packed().pop_back();
+        }
+        else
+        {
+            m_value.modify_array().pop_back();
+        }
     }
 
     // clear json and make empty
@@ -462,17 +703,53 @@ public:
         m_value.clear();
     }
 
+    // clear json, handing an object or array to a background thread to destroy
+    void clear_async()
+    {
+        if (is_object() || is_array())
+        {
+            json_release_queue<basic_json>::release(std::move(*this));
+        }
+        else
+        {
+            m_value.clear();
+        }
+    }
+
 
 public:
     template<typename Ty, 
         typename std::enable_if<std::is_default_constructible<Ty>::value && 
                 (std::is_convertible<Ty, basic_json>::value || has_from_json<Ty, basic_json>::value), 
                 int>::type = 0>
-    Ty get()const
+    Ty get()const&
     {
         return json_type_cast<Ty>(std::integral_constant<bool, has_from_json<Ty, basic_json>::value>());
     }
 
+    // get from an expiring json, a string, array or object is moved out
+    template<typename Ty, 
+        typename std::enable_if<std::is_default_constructible<Ty>::value && 
+                (std::is_convertible<Ty, basic_json>::value || has_from_json<Ty, basic_json>::value), 
+                int>::type = 0>
+    Ty get()&&
+    {
+        return take<Ty>();
+    }
+
+    // get the value and leave null behind, a string, array or object is
+    // moved out in O(1) unless it is shared with another json
+    template<typename Ty, 
+        typename std::enable_if<std::is_default_constructible<Ty>::value && 
+                (std::is_convertible<Ty, basic_json>::value || has_from_json<Ty, basic_json>::value), 
+                int>::type = 0>
+    Ty take()
+    {
+        Ty val = json_type_move<Ty>(std::integral_constant<bool, has_from_json<Ty, basic_json>::value>());
+        m_value.clear();
+        return val;
+    }
+
 
 private:
     template<typename Ty>
@@ -491,6 +768,84 @@ private:
         return val;
     }
 
+    template<typename Ty>
+    Ty json_type_move(std::false_type)
+    {
+        Ty val;
+        m_value.take(val);
+        return val;
+    }
+
+    template<typename Ty>
+    Ty json_type_move(std::true_type)
+    {
+        return json_type_cast<Ty>(std::true_type());
+    }
+
+
+public:
+    // a pointer to the stored object_t, array_t, string_t or number_big_integer_t,
+    // nullptr if the json holds another type. numbers and booleans are not
+    // addressable in every value layout, so they have no pointer
+    template<typename PointerType,
+        typename std::enable_if<std::is_pointer<PointerType>::value, int>::type = 0>
+    PointerType get_ptr()
+    {
+        return get_impl_ptr(static_cast<PointerType>(nullptr));
+    }
+
+    template<typename PointerType,
+        typename std::enable_if<std::is_pointer<PointerType>::value, int>::type = 0>
+    PointerType get_ptr()const
+    {
+        static_assert(std::is_const<typename std::remove_pointer<PointerType>::type>::value,
+                      "get_ptr() of a const json needs a pointer to const");
+        return get_impl_ptr(static_cast<PointerType>(nullptr));
+    }
+
+    // a reference to the stored value, like get_ptr() but throws on a type mismatch
+    template<typename ReferenceType,
+        typename std::enable_if<std::is_reference<ReferenceType>::value, int>::type = 0>
+    ReferenceType get_ref()
+    {
+        const auto ptr = get_ptr<typename std::add_pointer<ReferenceType>::type>();
+        if (ptr == nullptr)
+        {
+            throw json_type_error("get_ref() type does not match the json value type");
+        }
+
+        return *ptr;
+    }
+
+    template<typename ReferenceType,
+        typename std::enable_if<std::is_reference<ReferenceType>::value, int>::type = 0>
+    ReferenceType get_ref()const
+    {
+        const auto ptr = get_ptr<typename std::add_pointer<ReferenceType>::type>();
+        if (ptr == nullptr)
+        {
+            throw json_type_error("get_ref() type does not match the json value type");
+        }
+
+        return *ptr;
+    }
+
+
+private:
+    // the mutable ones detach and pin a shared container, see SJSON_COPY_ON_WRITE
+    object_t*       get_impl_ptr(object_t*)                 { return is_object() ? &m_value.object_value() : nullptr;   }
+    array_t*        get_impl_ptr(array_t*)                  { return is_array() ? &m_value.array_value() : nullptr;     }
+    string_t*       get_impl_ptr(string_t*)                 { return is_string() ? &m_value.string_value() : nullptr;   }
+
+    const object_t* get_impl_ptr(const object_t*)const      { return is_object() ? &m_value.object_value() : nullptr;   }
+    const array_t*  get_impl_ptr(const array_t*)const       { return is_array() ? &m_value.array_value() : nullptr;     }
+    const string_t* get_impl_ptr(const string_t*)const      { return is_string() ? &m_value.string_value() : nullptr;   }
+
+    const number_big_integer_t* get_impl_ptr(const number_big_integer_t*)const
+    {
+        return is_big_integer() ? &m_value.big_integer_value() : nullptr;
+    }
+
 
 public:
     const object_t& as_object()const
@@ -500,9 +855,10 @@ public:
             throw json_type_error("json value type must be object");
         }
 
-        return *m_value.m_data.object;
+        return m_value.object_value();
     }
 
+    // a packed array builds a general copy once, kept until it changes
     const array_t& as_array()const
     {
         if (!is_array())
@@ -510,7 +866,32 @@ public:
             throw json_type_error("json value type must be array");
         }
 
-        return *m_value.m_data.array;
+        return m_value.array_value();
+    }
+
+    // the elements of an array packed as Ty (number_integer_t or number_float_t), without copies
+    template<typename Ty,
+        typename std::enable_if<std::is_same<Ty, number_integer_t>::value ||
+                                std::is_same<Ty, number_float_t>::value, int>::type = 0>
+    json_span<const Ty> as_span()const
+    {
+        if (!is_array())
+        {
+            throw json_type_error("json value type must be array");
+        }
+
+        if (m_value.is_packed() && m_value.packed_value().template holds<Ty>())
+        {
+            const auto& elements = m_value.packed_value().template elements<Ty>();
+            return json_span<const Ty>(elements.data(), elements.size());
+        }
+
+        if (empty())
+        {
+            return json_span<const Ty>();
+        }
+
+        throw json_type_error("json array is not packed with the requested type");
     }
 
     const string_t& as_string()const
@@ -520,37 +901,79 @@ public:
             throw json_type_error("json value type must be string");
         }
 
-        return *m_value.m_data.string;
+        return m_value.string_value();
+    }
+
+    // a view of the string, nothing is copied
+    string_view_t as_string_view()const
+    {
+        return string_view_t(as_string());
     }
 
     number_integer_t as_int()const
     {
-        if (is_integer())
+        switch (type())
         {
-            return m_value.m_data.number_integer;
+            case value_t::number_integer:
+                return m_value.integer_value();
+
+            case value_t::number_unsigned:
+                if (m_value.unsigned_value() > static_cast<number_unsigned_t>(std::numeric_limits<number_integer_t>::max()))
+                {
+                    throw json_type_error("json unsigned integer does not fit in an integer");
+                }
+                return static_cast<number_integer_t>(m_value.unsigned_value());
+
+            case value_t::number_float:
+                return static_cast<number_integer_t>(m_value.float_value());
+
+            case value_t::number_big_integer:
+                throw json_type_error("json big integer does not fit in an integer");
+
+            default:
+                throw json_type_error("json value type must be number");
         }
+    }
 
-        if (is_float())
+    number_unsigned_t as_unsigned()const
+    {
+        switch (type())
         {
-            return static_cast<number_integer_t>(m_value.m_data.number_float);
-        }
+            case value_t::number_integer:
+                return static_cast<number_unsigned_t>(m_value.integer_value());
+
+            case value_t::number_unsigned:
+                return m_value.unsigned_value();
+
+            case value_t::number_float:
+                return static_cast<number_unsigned_t>(m_value.float_value());
+
+            case value_t::number_big_integer:
+                throw json_type_error("json big integer does not fit in an unsigned integer");
 
-        throw json_type_error("json value type must be number");
+            default:
+                throw json_type_error("json value type must be number");
+        }
     }
 
     number_float_t as_float()const
     {
-        if (is_integer())
+        if (!is_number())
         {
-            return static_cast<number_float_t>(m_value.m_data.number_integer);
+            throw json_type_error("json value type must be number");
         }
 
-        if (is_float())
+        return m_value.to_float();
+    }
+
+    const number_big_integer_t& as_big_integer()const
+    {
+        if (!is_big_integer())
         {
-            return m_value.m_data.number_float;
+            throw json_type_error("json value type must be big integer");
         }
 
-        throw json_type_error("json value type must be number");
+        return m_value.big_integer_value();
     }
 
     boolean_t as_bool()const
@@ -566,13 +989,19 @@ public:
             return empty();
         
         case value_t::number_integer:
-            return m_value.m_data.number_integer != 0;
+            return m_value.integer_value() != 0;
+
+        case value_t::number_unsigned:
+            return m_value.unsigned_value() != 0;
+
+        case value_t::number_big_integer:
+            return !m_value.big_integer_value().is_zero();
 
         case value_t::number_float:
-            return m_value.m_data.number_float != 0.0;
+            return m_value.float_value() != 0.0;
 
         case value_t::boolean:
-            return m_value.m_data.boolean;
+            return m_value.boolean_value();
 
         default:
             return false;
@@ -593,15 +1022,16 @@ public:
             throw json_invalid_key("operator[] called on a non-array object");
         }
 
-        auto array = m_value.m_data.array;
+        auto array = &m_value.array_value();
         if (index >= array->size())
         {
-            array->insert(array->end(), index - array->size() + 1, basic_json());
+            array->resize(index + 1);
         }
 
         return (*array)[index];
     }
 
+    // a packed array is not unpacked, see json_packed_array::element()
     const basic_json& operator[](size_type index)const
     {
         if (!is_array())
@@ -609,13 +1039,12 @@ public:
             throw json_invalid_key("json operator[] called on a non-array object");
         }
 
-        auto array = m_value.m_data.array;
-        if (index >= array->size())
+        if (index >= m_value.array_size())
         {
             throw std::out_of_range("json operator[] index out of range");
         }
 
-        return (*array)[index];
+        return m_value.element(index);
     }
 
     basic_json& operator[](const typename object_t::key_type& key)
@@ -630,7 +1059,7 @@ public:
             throw json_invalid_key("json operator[] called on a non-object type");
         }
 
-        return (*m_value.m_data.object)[key];
+        return m_value.object_value()[key];
     }
 
     const basic_json& operator[](const typename object_t::key_type& key)const
@@ -640,8 +1069,49 @@ public:
             throw json_invalid_key("json operator[] called on a non-object type");
         }
 
-        auto iter = m_value.m_data.object->find(key);
-        if (iter == m_value.m_data.object->end())
+        auto iter = m_value.object_value().find(key);
+        if (iter == m_value.object_value().end())
+        {
+            throw json_invalid_key("json operator[] key out of range");
+        }
+
+        return iter->second;
+    }
+
+    template<typename KeyType, enable_if_key_view<KeyType> = 0>
+    basic_json& operator[](const KeyType& key)
+    {
+        if (is_null())
+        {
+            m_value = json_value<basic_json>(value_t::object);
+        }
+
+        if (!is_object())
+        {
+            throw json_invalid_key("json operator[] called on a non-object type");
+        }
+
+        auto& object = m_value.object_value();
+        const string_view_t view(key);
+        const auto iter = find_key(object, view);
+        if (iter != object.end())
+        {
+            return iter->second;
+        }
+
+        return object.emplace(key_t(string_t(view.data(), view.size())), basic_json()).first->second;
+    }
+
+    template<typename KeyType, enable_if_key_view<KeyType> = 0>
+    const basic_json& operator[](const KeyType& key)const
+    {
+        if (!is_object())
+        {
+            throw json_invalid_key("json operator[] called on a non-object type");
+        }
+
+        auto iter = find_key(m_value.object_value(), key);
+        if (iter == m_value.object_value().end())
         {
             throw json_invalid_key("json operator[] key out of range");
         }
@@ -658,7 +1128,7 @@ public:
             throw json_invalid_key("json at called on a non-array object");
         }
 
-        auto array = m_value.m_data.array;
+        auto array = &m_value.array_value();
         if (index >= array->size())
         {
             throw std::out_of_range("json index out of range");
@@ -669,7 +1139,17 @@ public:
 
     const basic_json& at(size_type index)const
     {
-        return static_cast<basic_json*>(this)->at(index);
+        if (!is_array())
+        {
+            throw json_invalid_key("json at called on a non-array object");
+        }
+
+        if (index >= m_value.array_size())
+        {
+            throw std::out_of_range("json index out of range");
+        }
+
+        return m_value.element(index);
     }
 
     basic_json& at(const typename object_t::key_type& key)
@@ -679,8 +1159,8 @@ public:
             throw json_invalid_key("json at called on a non-object type");
         }
 
-        auto iter = m_value.m_data.object->find(key);
-        if (iter == m_value.m_data.object->end())
+        auto iter = m_value.object_value().find(key);
+        if (iter == m_value.object_value().end())
         {
             throw json_invalid_key("json at key out of range");
         }
@@ -690,7 +1170,219 @@ public:
 
     const basic_json& at(const typename object_t::key_type& key)const
     {
-        return static_cast<basic_json*>(this)->at(key);
+        if (!is_object())
+        {
+            throw json_invalid_key("json at called on a non-object type");
+        }
+
+        auto iter = m_value.object_value().find(key);
+        if (iter == m_value.object_value().end())
+        {
+            throw json_invalid_key("json at key out of range");
+        }
+
+        return iter->second;
+    }
+
+    template<typename KeyType, enable_if_key_view<KeyType> = 0>
+    basic_json& at(const KeyType& key)
+    {
+        if (!is_object())
+        {
+            throw json_invalid_key("json at called on a non-object type");
+        }
+
+        auto& object = m_value.object_value();
+        auto iter = find_key(object, key);
+        if (iter == object.end())
+        {
+            throw json_invalid_key("json at key out of range");
+        }
+
+        return iter->second;
+    }
+
+    template<typename KeyType, enable_if_key_view<KeyType> = 0>
+    const basic_json& at(const KeyType& key)const
+    {
+        if (!is_object())
+        {
+            throw json_invalid_key("json at called on a non-object type");
+        }
+
+        auto iter = find_key(m_value.object_value(), key);
+        if (iter == m_value.object_value().end())
+        {
+            throw json_invalid_key("json at key out of range");
+        }
+
+        return iter->second;
+    }
+
+
+public:
+    // JSON Pointer access, see json_pointer
+    basic_json& at(const json_pointer_t& pointer)
+    {
+        const auto json = resolve(*this, pointer);
+        if (json == nullptr)
+        {
+            throw json_invalid_key("json at pointer out of range");
+        }
+
+        return *json;
+    }
+
+    const basic_json& at(const json_pointer_t& pointer)const
+    {
+        const auto json = resolve(*this, pointer);
+        if (json == nullptr)
+        {
+            throw json_invalid_key("json at pointer out of range");
+        }
+
+        return *json;
+    }
+
+    bool contains(const json_pointer_t& pointer)const
+    {
+        return resolve(*this, pointer) != nullptr;
+    }
+
+    // the value the pointer refers to, or default_value if there is none
+    template<typename Ty>
+    Ty value(const json_pointer_t& pointer, const Ty& default_value)const
+    {
+        const auto json = resolve(*this, pointer);
+        return json != nullptr ? json->template get<Ty>() : default_value;
+    }
+
+    string_t value(const json_pointer_t& pointer, const char_type* default_value)const
+    {
+        return value(pointer, string_t(default_value));
+    }
+
+public:
+    // apply a RFC 6902 JSON Patch in place, see json_patch. an atomic patch
+    // that fails leaves the json as it was, otherwise the operations before
+    // the failed one stay applied. the values of an rvalue patch are moved
+    void apply_patch(const basic_json& patch, const bool atomic = true)
+    {
+        json_patch<basic_json>::apply(*this, patch, atomic);
+    }
+
+    void apply_patch(basic_json&& patch, const bool atomic = true)
+    {
+        json_patch<basic_json>::apply(*this, patch, atomic);
+    }
+
+    // apply a RFC 7396 Merge Patch in place
+    void merge_patch(const basic_json& patch)
+    {
+        json_patch<basic_json>::merge(*this, patch);
+    }
+
+    void merge_patch(basic_json&& patch)
+    {
+        json_patch<basic_json>::merge(*this, patch);
+    }
+
+    // the JSON Patch that turns source into target
+    static basic_json diff(const basic_json& source, const basic_json& target)
+    {
+        return json_patch<basic_json>::diff(source, target);
+    }
+
+private:
+    // a mutable element unpacks a packed array, a const one reads it from its views
+    static basic_json& array_element(basic_json& json, const size_type index)
+    {
+        return json.m_value.array_value()[index];
+    }
+
+    static const basic_json& array_element(const basic_json& json, const size_type index)
+    {
+        return json.m_value.element(index);
+    }
+
+    // the json the pointer refers to, nullptr if there is none
+    template<typename JsonType>
+    static JsonType* resolve(JsonType& root, const json_pointer_t& pointer)
+    {
+        JsonType* json = &root;
+        for (const auto& token : pointer)
+        {
+            if (json->is_object())
+            {
+                auto& object = json->m_value.object_value();
+                const auto iter = object.find(token.key);
+                if (iter == object.end())
+                {
+                    return nullptr;
+                }
+                json = &iter->second;
+            }
+            else if (json->is_array())
+            {
+                if (token.index >= json->m_value.array_size())
+                {
+                    return nullptr;
+                }
+                json = &array_element(*json, token.index);
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+        return json;
+    }
+
+
+private:
+    // a std::map finds a view through json_key_less since C++14
+    using transparent_lookup = std::integral_constant<bool,
+        json_object_type<ObjectType, key_t, basic_json, StringType>::transparent && (__cplusplus >= 201402L)>;
+
+    template<typename Object>
+    static auto find_key(Object& object, const string_view_t key) -> decltype(object.begin())
+    {
+        return find_key(object, key, transparent_lookup());
+    }
+
+    template<typename Object>
+    static auto find_key(Object& object, const string_view_t key, std::true_type) -> decltype(object.begin())
+    {
+        return object.find(key);
+    }
+
+    template<typename Object>
+    static auto find_key(Object& object, const string_view_t key, std::false_type) -> decltype(object.begin())
+    {
+        const key_t* lookup = lookup_key(key);
+        return lookup != nullptr ? object.find(*lookup) : object.end();
+    }
+
+    // C++11 maps and other object types have no heterogeneous lookup, a
+    // thread-local key is reused instead, so a lookup does not allocate once
+    // it has grown. null if no object can have the key, a lookup never
+    // interns an atom
+    static const key_t* lookup_key(const string_view_t key)
+    {
+        static thread_local string_t buffer;
+        buffer.assign(key.data(), key.size());
+        return to_key(buffer, std::is_same<key_t, string_t>());
+    }
+
+    static const key_t* to_key(const string_t& str, std::true_type)
+    {
+        return &str;
+    }
+
+    static const key_t* to_key(const string_t& str, std::false_type)
+    {
+        static thread_local key_t key;
+        return key_t::find(str, key) ? &key : nullptr;
     }
 
 
@@ -717,6 +1409,33 @@ public:
         return !(lhs.m_value == rhs.m_value);
     }
 
+    // a total order of every json, see json_value::compare()
+    friend bool operator<(const basic_json& lhs, const basic_json& rhs)
+    {
+        return json_value<basic_json>::compare(lhs.m_value, rhs.m_value) < 0;
+    }
+
+    friend bool operator<=(const basic_json& lhs, const basic_json& rhs)
+    {
+        return json_value<basic_json>::compare(lhs.m_value, rhs.m_value) <= 0;
+    }
+
+    friend bool operator>(const basic_json& lhs, const basic_json& rhs)
+    {
+        return json_value<basic_json>::compare(lhs.m_value, rhs.m_value) > 0;
+    }
+
+    friend bool operator>=(const basic_json& lhs, const basic_json& rhs)
+    {
+        return json_value<basic_json>::compare(lhs.m_value, rhs.m_value) >= 0;
+    }
+
+    // a structural hash, equal json have equal hashes, see json_value::hash()
+    std::size_t hash()const
+    {
+        return m_value.hash();
+    }
+
 
     // dump functions
 public:
@@ -742,6 +1461,49 @@ public:
         return result;
     }
 
+    // the number of characters dump(indent) writes. it walks the whole document
+    // and formats every float, so it costs about half a dump
+    size_type serialized_size(const unsigned int indent = 0)const
+    {
+        buffer_output_adapter<char_type> no_output(nullptr);
+        return json_serializer<basic_json>(no_output, ' ').size(*this, indent);
+    }
+
+    // appends the text to out, which grows once to the size serialized_size()
+    // counts, or not at all if its capacity is enough, and returns its length.
+    // for large documents, or a buffer reused across documents: dump() grows
+    // its string by doubling, which is faster but copies the text a few times
+    // and can leave up to half of the capacity unused
+    size_type dump_to(
+        string_t& out,
+        const unsigned int indent = 0,
+        const char_type indent_char = ' ')const
+    {
+        const auto offset = out.size();
+        const auto length = serialized_size(indent);
+        out.resize(offset + length);
+        if (length > 0)
+        {
+            buffer_output_adapter<char_type> buffer_output(&out[offset]);
+            dump(buffer_output, indent, indent_char);
+        }
+        return length;
+    }
+
+    // writes at most capacity characters into buffer, without a terminating
+    // null, and returns the size of the whole text like snprintf: a result
+    // above capacity means the text was cut off
+    size_type dump_to(
+        char_type* buffer,
+        const size_type capacity,
+        const unsigned int indent = 0,
+        const char_type indent_char = ' ')const
+    {
+        bounded_output_adapter<char_type> bounded_output(buffer, capacity);
+        dump(bounded_output, indent, indent_char);
+        return bounded_output.size();
+    }
+
 
     void dump(
         output_adapter<char_type>& oa,
@@ -0,0 +1,279 @@
+#ifndef JSON_BIG_INTEGER_HPP
+#define JSON_BIG_INTEGER_HPP
+
+#include <cstddef>      // size_t, ptrdiff_t
+#include <cstdint>      // uint32_t, uint64_t
+#include <cmath>        // frexp, ldexp
+#include <limits>       // numeric_limits
+#include <string>       // string
+#include <vector>       // vector
+#include <type_traits>  // enable_if, is_integral, is_signed, make_unsigned
+#include <ostream>      // basic_ostream
+#include "json_exception.hpp"
+#include "json_float.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_big_integer, an integer of any width kept as its canonical decimal
+// text: an optional '-' and digits without leading zeros, "0" for zero.
+// it is stored, compared and written exactly, no arithmetic is provided
+//
+template<typename StringType>
+class json_big_integer
+{
+public:
+    using string_type   = StringType;
+    using char_type     = typename StringType::value_type;
+
+public:
+    json_big_integer() : m_text(1, char_type('0')) { }
+
+    explicit json_big_integer(const StringType& text) : m_text(canonical(text)) { }
+
+    explicit json_big_integer(const char_type* text) : m_text(canonical(StringType(text))) { }
+
+    template<typename Integer,
+            typename std::enable_if<std::is_integral<Integer>::value, int>::type = 0>
+    explicit json_big_integer(const Integer num)
+    {
+        using unsigned_type = typename std::make_unsigned<Integer>::type;
+
+        const bool negative = std::is_signed<Integer>::value && num < 0;
+        auto uval = negative ? static_cast<unsigned_type>(0) - static_cast<unsigned_type>(num) : static_cast<unsigned_type>(num);
+        do
+        {
+            m_text.insert(m_text.begin(), static_cast<char_type>('0' + uval % 10));
+            uval /= 10;
+        } while (uval);
+
+        if (negative)
+        {
+            m_text.insert(m_text.begin(), char_type('-'));
+        }
+    }
+
+    const StringType& str()const noexcept   { return m_text;                    }
+
+    bool negative()const noexcept           { return m_text[0] == '-';          }
+
+    bool is_zero()const noexcept            { return m_text.size() == 1 && m_text[0] == '0'; }
+
+    // the nearest Floating, rounded correctly like the parser rounds a float
+    template<typename Floating>
+    Floating to_float()const
+    {
+        const std::size_t begin = negative() ? 1 : 0;
+        const std::size_t length = m_text.size() - begin;
+
+        std::uint64_t significand = 0;
+        for (std::size_t i = 0; i < length && i < max_significand_digits; ++i)
+        {
+            significand = significand * 10 + static_cast<std::uint64_t>(m_text[begin + i] - '0');
+        }
+
+        Floating result;
+        if (length <= max_significand_digits)
+        {
+            result = make_float<Floating>(significand, 0);
+        }
+        else
+        {
+            const std::string digits(m_text.begin() + static_cast<std::ptrdiff_t>(begin), m_text.end());
+            result = make_float<Floating>(significand, 0, digits.data(), digits.size());
+        }
+        return negative() ? -result : result;
+    }
+
+
+    // negative, zero or positive as the integer is below, equal to or above
+    // val, exactly: the integer part of val is expanded to all its decimal
+    // digits and compared with the text. a NaN is above every integer
+    template<typename Floating>
+    int compare(const Floating val)const
+    {
+        if (val != val)
+        {
+            return -1;
+        }
+        if (is_zero() || negative() != (val < 0))
+        {
+            return is_zero() ? (val > 0 ? -1 : (val < 0 ? 1 : 0)) : (negative() ? -1 : 1);
+        }
+
+        const int result = compare_magnitude(negative() ? -val : val);
+        return negative() ? -result : result;
+    }
+
+
+public:
+    friend bool operator==(const json_big_integer& lhs, const json_big_integer& rhs)  { return lhs.m_text == rhs.m_text;   }
+    friend bool operator!=(const json_big_integer& lhs, const json_big_integer& rhs)  { return lhs.m_text != rhs.m_text;   }
+
+    friend bool operator<(const json_big_integer& lhs, const json_big_integer& rhs)
+    {
+        if (lhs.negative() != rhs.negative())
+        {
+            return lhs.negative();
+        }
+
+        // same sign, a longer magnitude is further from zero
+        const bool less = lhs.m_text.size() != rhs.m_text.size() ?
+            lhs.m_text.size() < rhs.m_text.size() : lhs.m_text < rhs.m_text;
+        return lhs.negative() ? (lhs != rhs && !less) : less;
+    }
+
+    friend bool operator> (const json_big_integer& lhs, const json_big_integer& rhs)  { return rhs < lhs;      }
+    friend bool operator<=(const json_big_integer& lhs, const json_big_integer& rhs)  { return !(rhs < lhs);   }
+    friend bool operator>=(const json_big_integer& lhs, const json_big_integer& rhs)  { return !(lhs < rhs);   }
+
+    friend std::basic_ostream<char_type>& operator<<(std::basic_ostream<char_type>& os, const json_big_integer& num)
+    {
+        return os << num.m_text;
+    }
+
+
+private:
+    // mag > 0, the digits without the sign against it
+    template<typename Floating>
+    int compare_magnitude(const Floating mag)const
+    {
+        static_assert(std::numeric_limits<Floating>::digits <= 64, "the significand of Floating must fit in 64 bits");
+
+        if (mag > std::numeric_limits<Floating>::max())
+        {
+            return -1;
+        }
+
+        // mag == significand * 2^exponent exactly
+        int exponent = 0;
+        const Floating fraction = std::frexp(mag, &exponent);
+        std::uint64_t significand = static_cast<std::uint64_t>(std::ldexp(fraction, std::numeric_limits<Floating>::digits));
+        exponent -= std::numeric_limits<Floating>::digits;
+
+        // the integer part, and whether bits are left after the point
+        bool has_fraction = false;
+        if (exponent < 0)
+        {
+            const std::uint64_t whole = -exponent < 64 ? significand >> -exponent : 0;
+            has_fraction = -exponent >= 64 || (whole << -exponent) != significand;
+            significand = whole;
+            exponent = 0;
+        }
+
+        // the integer part in base 10^9 limbs, lowest first, shifted left by exponent
+        constexpr std::uint32_t limb_base = 1000000000u;
+        std::vector<std::uint32_t> limbs;
+        for (; significand != 0; significand /= limb_base)
+        {
+            limbs.push_back(static_cast<std::uint32_t>(significand % limb_base));
+        }
+        while (exponent > 0)
+        {
+            const int shift = exponent < 29 ? exponent : 29;
+            std::uint64_t carry = 0;
+            for (auto& limb : limbs)
+            {
+                const std::uint64_t product = (static_cast<std::uint64_t>(limb) << shift) + carry;
+                limb = static_cast<std::uint32_t>(product % limb_base);
+                carry = product / limb_base;
+            }
+            for (; carry != 0; carry /= limb_base)
+            {
+                limbs.push_back(static_cast<std::uint32_t>(carry % limb_base));
+            }
+            exponent -= shift;
+        }
+
+        std::string whole_digits;
+        for (std::size_t i = limbs.size(); i-- > 0;)
+        {
+            char buffer[10] = { 0 };
+            for (int pos = 8; pos >= 0; --pos)
+            {
+                buffer[pos] = static_cast<char>('0' + limbs[i] % 10);
+                limbs[i] /= 10;
+            }
+            const char* first = buffer;
+            if (whole_digits.empty())
+            {
+                for (; *first == '0' && first[1] != 0; ++first)
+                {
+                }
+            }
+            whole_digits.append(first);
+        }
+        if (whole_digits.empty() || whole_digits == "0")
+        {
+            // mag < 1, below any nonzero integer
+            return 1;
+        }
+
+        const std::size_t begin = negative() ? 1 : 0;
+        const std::size_t length = m_text.size() - begin;
+        if (length != whole_digits.size())
+        {
+            return length < whole_digits.size() ? -1 : 1;
+        }
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            const auto digit = static_cast<char>(m_text[begin + i]);
+            if (digit != whole_digits[i])
+            {
+                return digit < whole_digits[i] ? -1 : 1;
+            }
+        }
+        return has_fraction ? -1 : 0;
+    }
+
+    static StringType canonical(const StringType& text)
+    {
+        std::size_t begin = (!text.empty() && text[0] == '-') ? 1 : 0;
+        if (begin == text.size())
+        {
+            throw json_type_error("invalid big integer text");
+        }
+
+        for (std::size_t i = begin; i < text.size(); ++i)
+        {
+            if (text[i] < '0' || text[i] > '9')
+            {
+                throw json_type_error("invalid big integer text");
+            }
+        }
+
+        const bool negative = begin == 1;
+        while (begin + 1 < text.size() && text[begin] == '0')
+        {
+            ++begin;
+        }
+
+        if (text.size() - begin == 1 && text[begin] == '0')
+        {
+            return StringType(1, char_type('0'));
+        }
+
+        StringType result;
+        if (negative)
+        {
+            result.push_back(char_type('-'));
+        }
+        result.append(text, begin, StringType::npos);
+        return result;
+    }
+
+private:
+    StringType  m_text;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_BIG_INTEGER_HPP
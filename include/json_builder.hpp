@@ -0,0 +1,153 @@
+#ifndef JSON_BUILDER_HPP
+#define JSON_BUILDER_HPP
+
+#include <cstddef>      // size_t
+#include <tuple>        // forward_as_tuple
+#include <utility>      // forward, move, piecewise_construct
+#include "json_utils.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_object_builder and json_array_builder fill an object_t or array_t and
+// hand it to a basic_json with build(). unlike an initializer_list, whose
+// elements are const and so copied, every value is constructed in place
+// from the arguments or moved in
+//
+
+template<typename BasicJsonType>
+class json_object_builder
+{
+public:
+    using object_t  = typename BasicJsonType::object_t;
+    using key_t     = typename BasicJsonType::key_t;
+    using size_type = std::size_t;
+
+public:
+    json_object_builder() = default;
+
+    explicit json_object_builder(const size_type count)
+    {
+        reserve(count);
+    }
+
+    // a no-op for an object_t without reserve, such as std::map
+    json_object_builder& reserve(const size_type count)
+    {
+        reserve_container(m_object, count);
+        return *this;
+    }
+
+    // the value is constructed from args, an existing key keeps its value
+    template<typename KeyType, typename... Args>
+    json_object_builder& emplace(KeyType&& key, Args&&... args)
+    {
+        m_object.emplace(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<KeyType>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        return *this;
+    }
+
+    // key, value, key, value...
+    json_object_builder& emplace_pairs()
+    {
+        return *this;
+    }
+
+    template<typename KeyType, typename ValueType, typename... Rest>
+    json_object_builder& emplace_pairs(KeyType&& key, ValueType&& value, Rest&&... rest)
+    {
+        static_assert(sizeof...(Rest) % 2 == 0, "json object needs a value for every key");
+        emplace(std::forward<KeyType>(key), std::forward<ValueType>(value));
+        return emplace_pairs(std::forward<Rest>(rest)...);
+    }
+
+    size_type size()const noexcept  { return m_object.size();   }
+
+    // the builder is left empty
+    BasicJsonType build()
+    {
+        return BasicJsonType(std::move(m_object));
+    }
+
+private:
+    object_t    m_object;
+};
+
+
+template<typename BasicJsonType>
+class json_array_builder
+{
+public:
+    using array_t   = typename BasicJsonType::array_t;
+    using size_type = std::size_t;
+
+public:
+    json_array_builder() = default;
+
+    explicit json_array_builder(const size_type count)
+    {
+        reserve(count);
+    }
+
+    json_array_builder& reserve(const size_type count)
+    {
+        reserve_container(m_array, count);
+        return *this;
+    }
+
+    template<typename... Args>
+    json_array_builder& emplace_back(Args&&... args)
+    {
+        m_array.emplace_back(std::forward<Args>(args)...);
+        return *this;
+    }
+
+    json_array_builder& push_back(BasicJsonType&& value)
+    {
+        m_array.push_back(std::move(value));
+        return *this;
+    }
+
+    json_array_builder& push_back(const BasicJsonType& value)
+    {
+        m_array.push_back(value);
+        return *this;
+    }
+
+    // every argument is one element
+    json_array_builder& emplace_all()
+    {
+        return *this;
+    }
+
+    template<typename ValueType, typename... Rest>
+    json_array_builder& emplace_all(ValueType&& value, Rest&&... rest)
+    {
+        m_array.emplace_back(std::forward<ValueType>(value));
+        return emplace_all(std::forward<Rest>(rest)...);
+    }
+
+    size_type size()const noexcept  { return m_array.size();    }
+
+    // the builder is left empty
+    BasicJsonType build()
+    {
+        return BasicJsonType(std::move(m_array));
+    }
+
+private:
+    array_t     m_array;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_BUILDER_HPP
@@ -0,0 +1,152 @@
+#ifndef JSON_ESCAPE_HPP
+#define JSON_ESCAPE_HPP
+
+#include <cstddef>      // size_t
+
+#if !defined(SJSON_NO_SIMD)
+#   if defined(__AVX2__)
+#       define SJSON_ESCAPE_AVX2
+#       include <immintrin.h>
+#   elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define SJSON_ESCAPE_SSE2
+#       include <emmintrin.h>
+#   endif
+#   if defined(_MSC_VER) && (defined(SJSON_ESCAPE_AVX2) || defined(SJSON_ESCAPE_SSE2))
+#       include <intrin.h>
+#   endif
+#endif
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// find_escape and write_escape, the two halves of writing a JSON string.
+//
+// find_escape returns the first character that must be escaped: a quote, a
+// backslash or a control character below 0x20. it tests 32 characters at a
+// time with AVX2 or 16 with SSE2 when the compiler targets them, unless
+// SJSON_NO_SIMD is defined, and one per step from a table otherwise. the
+// characters before it are written as they are.
+//
+// write_escape writes the escape of one such character: \" \\ \b \f \n \r \t,
+// and \u00XX for the other control characters
+//
+
+// the longest escape, \u00XX
+constexpr std::size_t max_escape_size = 6;
+
+// the character after the backslash, 'u' for \u00XX, 0 if none is needed
+inline const char* escape_table()noexcept
+{
+    static const char table[256] =
+    {
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+        0,   0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+        0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+        0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+        0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   '\\', 0,  0,   0,
+        // 0x60 to 0xFF need no escape
+    };
+    return table;
+}
+
+inline bool needs_escape(const char ch)noexcept
+{
+    return escape_table()[static_cast<unsigned char>(ch)] != 0;
+}
+
+#if defined(SJSON_ESCAPE_AVX2) || defined(SJSON_ESCAPE_SSE2)
+// mask != 0
+inline unsigned int lowest_bit(const unsigned int mask)noexcept
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+inline const char* find_escape(const char* first, const char* const last)noexcept
+{
+#if defined(SJSON_ESCAPE_AVX2)
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1F);
+    for (; last - first >= 32; first += 32)
+    {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        // chars <= 0x1F, unsigned
+        const __m256i is_control = _mm256_cmpeq_epi8(_mm256_max_epu8(chars, control), control);
+        const __m256i hits = _mm256_or_si256(is_control,
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, quote), _mm256_cmpeq_epi8(chars, backslash)));
+        const auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(hits));
+        if (mask != 0)
+        {
+            return first + lowest_bit(mask);
+        }
+    }
+#endif
+
+#if defined(SJSON_ESCAPE_AVX2) || defined(SJSON_ESCAPE_SSE2)
+    const __m128i quote16 = _mm_set1_epi8('"');
+    const __m128i backslash16 = _mm_set1_epi8('\\');
+    const __m128i control16 = _mm_set1_epi8(0x1F);
+    for (; last - first >= 16; first += 16)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const __m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(chars, control16), control16);
+        const __m128i hits = _mm_or_si128(is_control,
+            _mm_or_si128(_mm_cmpeq_epi8(chars, quote16), _mm_cmpeq_epi8(chars, backslash16)));
+        const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(hits));
+        if (mask != 0)
+        {
+            return first + lowest_bit(mask);
+        }
+    }
+#endif
+
+    for (; first != last && !needs_escape(*first); ++first)
+    {
+    }
+    return first;
+}
+
+// the number of characters write_escape writes for ch
+inline std::size_t escape_size(const char ch)noexcept
+{
+    return escape_table()[static_cast<unsigned char>(ch)] == 'u' ? max_escape_size : 2;
+}
+
+// ch needs an escape, writes max_escape_size characters at most and returns their end
+inline char* write_escape(char* out, const char ch)noexcept
+{
+    const auto code = static_cast<unsigned char>(ch);
+    const char escape = escape_table()[code];
+
+    *out++ = '\\';
+    *out++ = escape;
+    if (escape == 'u')
+    {
+        static const char hex[] = "0123456789ABCDEF";
+        *out++ = '0';
+        *out++ = '0';
+        *out++ = hex[code >> 4];
+        *out++ = hex[code & 0x0F];
+    }
+    return out;
+}
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_ESCAPE_HPP
@@ -65,6 +65,17 @@ public:
 };
 
 
+class json_patch_error : public json_exception
+{
+public:
+    explicit json_patch_error(const char* msg)
+        : json_exception(msg) { }
+
+    explicit json_patch_error(const std::string& msg)
+        : json_exception(msg) { }
+};
+
+
 } // namespace detail
 
 } // namespace sjson
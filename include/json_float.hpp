@@ -0,0 +1,739 @@
+#ifndef JSON_FLOAT_HPP
+#define JSON_FLOAT_HPP
+
+#include <cstdint>      // uint32_t, uint64_t
+#include <cstdio>       // snprintf
+#include <cstdlib>      // strtof, strtod, strtold
+#include <cstring>      // memcpy, memmove, memset
+#include <cmath>        // isfinite, signbit
+#include <limits>       // numeric_limits
+#include <type_traits>  // conditional, integral_constant
+#include <string>       // string
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// format_float, the shortest decimal text that parses back to the same float,
+// written into a buffer without allocating or touching the locale.
+//
+// the digits come from Grisu3 (Florian Loitsch, "Printing Floating-Point
+// Numbers Quickly and Accurately with Integers", PLDI 2010), which works on
+// 64-bit integers and a table of 79 cached powers of ten. Grisu3 either proves
+// its digits are the shortest correctly rounded ones or gives up, for about
+// 0.5% of doubles; those are found by printing 1, 2... max_digits10 digits
+// with snprintf until one parses back
+//
+namespace dtoa
+{
+
+
+// f * 2^e
+struct diy_fp
+{
+    std::uint64_t   f;
+    int             e;
+
+    constexpr diy_fp(std::uint64_t significand, int exponent)noexcept : f(significand), e(exponent) { }
+
+    // same exponents, a.f >= b.f
+    static diy_fp minus(const diy_fp& a, const diy_fp& b)noexcept
+    {
+        return diy_fp(a.f - b.f, a.e);
+    }
+
+    // the upper 64 bits of the product, rounded
+    static diy_fp times(const diy_fp& a, const diy_fp& b)noexcept
+    {
+        const std::uint64_t mask = 0xFFFFFFFFu;
+        const std::uint64_t ah = a.f >> 32, al = a.f & mask;
+        const std::uint64_t bh = b.f >> 32, bl = b.f & mask;
+
+        const std::uint64_t hh = ah * bh;
+        const std::uint64_t hl = ah * bl;
+        const std::uint64_t lh = al * bh;
+        const std::uint64_t ll = al * bl;
+
+        std::uint64_t mid = (ll >> 32) + (hl & mask) + (lh & mask);
+        mid += std::uint64_t(1) << 31;
+        return diy_fp(hh + (hl >> 32) + (lh >> 32) + (mid >> 32), a.e + b.e + 64);
+    }
+
+    // x.f != 0, shifted in halving steps
+    static diy_fp normalize(diy_fp x)noexcept
+    {
+        for (int shift = 32; shift != 0; shift /= 2)
+        {
+            if ((x.f >> (64 - shift)) == 0)
+            {
+                x.f <<= shift;
+                x.e -= shift;
+            }
+        }
+        return x;
+    }
+
+    // x.e >= e, and x.f shifted by x.e - e still fits
+    static diy_fp normalize_to(const diy_fp& x, const int e)noexcept
+    {
+        return diy_fp(x.f << (x.e - e), e);
+    }
+};
+
+
+// the value and the boundaries m- and m+ of the interval that rounds to it,
+// m- normalized to the exponent of m+
+struct boundaries
+{
+    diy_fp w;
+    diy_fp minus;
+    diy_fp plus;
+};
+
+template<typename FloatType>
+boundaries compute_boundaries(const FloatType value)noexcept
+{
+    using bits_type = typename std::conditional<std::numeric_limits<FloatType>::digits == 24, std::uint32_t, std::uint64_t>::type;
+
+    constexpr int precision = std::numeric_limits<FloatType>::digits;      // with the hidden bit
+    constexpr int bias = std::numeric_limits<FloatType>::max_exponent - 1 + (precision - 1);
+    constexpr int min_exponent = 1 - bias;
+    constexpr std::uint64_t hidden_bit = std::uint64_t(1) << (precision - 1);
+
+    bits_type raw;
+    std::memcpy(&raw, &value, sizeof(raw));
+    const std::uint64_t bits = raw;
+    const std::uint64_t biased_exponent = bits >> (precision - 1);
+    const std::uint64_t fraction = bits & (hidden_bit - 1);
+
+    const diy_fp v = biased_exponent == 0 ?
+        diy_fp(fraction, min_exponent) :
+        diy_fp(fraction + hidden_bit, static_cast<int>(biased_exponent) - bias);
+
+    // the gap below a power of two is half the gap above it
+    const bool lower_is_closer = fraction == 0 && biased_exponent > 1;
+    const diy_fp plus = diy_fp::normalize(diy_fp(2 * v.f + 1, v.e - 1));
+    const diy_fp minus = lower_is_closer ? diy_fp(4 * v.f - 1, v.e - 2) : diy_fp(2 * v.f - 1, v.e - 1);
+
+    return boundaries{ diy_fp::normalize(v), diy_fp::normalize_to(minus, plus.e), plus };
+}
+
+
+// the scaled value w * c has an exponent in [min_target, max_target],
+// so its integral part fits in 32 bits
+constexpr int min_target = -60;
+constexpr int max_target = -32;
+
+struct cached_power
+{
+    std::uint64_t   f;
+    int             e;
+    int             k;      // f * 2^e ~ 10^k
+};
+
+constexpr int min_cached_exponent = -300;
+constexpr int max_cached_exponent = 324;
+constexpr int cached_step = 8;
+
+// 10^k for k = -300, -292... 324
+inline const cached_power* cached_powers()noexcept
+{
+    static const cached_power powers[] =
+    {
+        { 0xAB70FE17C79AC6CAull, -1060, -300 },
+        { 0xFF77B1FCBEBCDC4Full, -1034, -292 },
+        { 0xBE5691EF416BD60Cull, -1007, -284 },
+        { 0x8DD01FAD907FFC3Cull,  -980, -276 },
+        { 0xD3515C2831559A83ull,  -954, -268 },
+        { 0x9D71AC8FADA6C9B5ull,  -927, -260 },
+        { 0xEA9C227723EE8BCBull,  -901, -252 },
+        { 0xAECC49914078536Dull,  -874, -244 },
+        { 0x823C12795DB6CE57ull,  -847, -236 },
+        { 0xC21094364DFB5637ull,  -821, -228 },
+        { 0x9096EA6F3848984Full,  -794, -220 },
+        { 0xD77485CB25823AC7ull,  -768, -212 },
+        { 0xA086CFCD97BF97F4ull,  -741, -204 },
+        { 0xEF340A98172AACE5ull,  -715, -196 },
+        { 0xB23867FB2A35B28Eull,  -688, -188 },
+        { 0x84C8D4DFD2C63F3Bull,  -661, -180 },
+        { 0xC5DD44271AD3CDBAull,  -635, -172 },
+        { 0x936B9FCEBB25C996ull,  -608, -164 },
+        { 0xDBAC6C247D62A584ull,  -582, -156 },
+        { 0xA3AB66580D5FDAF6ull,  -555, -148 },
+        { 0xF3E2F893DEC3F126ull,  -529, -140 },
+        { 0xB5B5ADA8AAFF80B8ull,  -502, -132 },
+        { 0x87625F056C7C4A8Bull,  -475, -124 },
+        { 0xC9BCFF6034C13053ull,  -449, -116 },
+        { 0x964E858C91BA2655ull,  -422, -108 },
+        { 0xDFF9772470297EBDull,  -396, -100 },
+        { 0xA6DFBD9FB8E5B88Full,  -369,  -92 },
+        { 0xF8A95FCF88747D94ull,  -343,  -84 },
+        { 0xB94470938FA89BCFull,  -316,  -76 },
+        { 0x8A08F0F8BF0F156Bull,  -289,  -68 },
+        { 0xCDB02555653131B6ull,  -263,  -60 },
+        { 0x993FE2C6D07B7FACull,  -236,  -52 },
+        { 0xE45C10C42A2B3B06ull,  -210,  -44 },
+        { 0xAA242499697392D3ull,  -183,  -36 },
+        { 0xFD87B5F28300CA0Eull,  -157,  -28 },
+        { 0xBCE5086492111AEBull,  -130,  -20 },
+        { 0x8CBCCC096F5088CCull,  -103,  -12 },
+        { 0xD1B71758E219652Cull,   -77,   -4 },
+        { 0x9C40000000000000ull,   -50,    4 },
+        { 0xE8D4A51000000000ull,   -24,   12 },
+        { 0xAD78EBC5AC620000ull,     3,   20 },
+        { 0x813F3978F8940984ull,    30,   28 },
+        { 0xC097CE7BC90715B3ull,    56,   36 },
+        { 0x8F7E32CE7BEA5C70ull,    83,   44 },
+        { 0xD5D238A4ABE98068ull,   109,   52 },
+        { 0x9F4F2726179A2245ull,   136,   60 },
+        { 0xED63A231D4C4FB27ull,   162,   68 },
+        { 0xB0DE65388CC8ADA8ull,   189,   76 },
+        { 0x83C7088E1AAB65DBull,   216,   84 },
+        { 0xC45D1DF942711D9Aull,   242,   92 },
+        { 0x924D692CA61BE758ull,   269,  100 },
+        { 0xDA01EE641A708DEAull,   295,  108 },
+        { 0xA26DA3999AEF774Aull,   322,  116 },
+        { 0xF209787BB47D6B85ull,   348,  124 },
+        { 0xB454E4A179DD1877ull,   375,  132 },
+        { 0x865B86925B9BC5C2ull,   402,  140 },
+        { 0xC83553C5C8965D3Dull,   428,  148 },
+        { 0x952AB45CFA97A0B3ull,   455,  156 },
+        { 0xDE469FBD99A05FE3ull,   481,  164 },
+        { 0xA59BC234DB398C25ull,   508,  172 },
+        { 0xF6C69A72A3989F5Cull,   534,  180 },
+        { 0xB7DCBF5354E9BECEull,   561,  188 },
+        { 0x88FCF317F22241E2ull,   588,  196 },
+        { 0xCC20CE9BD35C78A5ull,   614,  204 },
+        { 0x98165AF37B2153DFull,   641,  212 },
+        { 0xE2A0B5DC971F303Aull,   667,  220 },
+        { 0xA8D9D1535CE3B396ull,   694,  228 },
+        { 0xFB9B7CD9A4A7443Cull,   720,  236 },
+        { 0xBB764C4CA7A44410ull,   747,  244 },
+        { 0x8BAB8EEFB6409C1Aull,   774,  252 },
+        { 0xD01FEF10A657842Cull,   800,  260 },
+        { 0x9B10A4E5E9913129ull,   827,  268 },
+        { 0xE7109BFBA19C0C9Dull,   853,  276 },
+        { 0xAC2820D9623BF429ull,   880,  284 },
+        { 0x80444B5E7AA7CF85ull,   907,  292 },
+        { 0xBF21E44003ACDD2Dull,   933,  300 },
+        { 0x8E679C2F5E44FF8Full,   960,  308 },
+        { 0xD433179D9C8CB841ull,   986,  316 },
+        { 0x9E19DB92B4E31BA9ull,  1013,  324 },
+    };
+    return powers;
+}
+
+// a c = f * 2^e ~ 10^k with min_target <= e + c.e + 64 <= max_target
+inline cached_power get_cached_power(const int e)noexcept
+{
+    // k = ceil((min_target - e - 1) * log10(2)), 78913 / 2^18 ~ log10(2)
+    const int f = min_target - e - 1;
+    const int k = (f * 78913) / (1 << 18) + static_cast<int>(f > 0);
+    const int index = (-min_cached_exponent + k + (cached_step - 1)) / cached_step;
+    return cached_powers()[index];
+}
+
+// the cached 10^k with exponent - cached_step < k <= exponent,
+// exponent in [min_cached_exponent, max_cached_exponent + cached_step)
+inline cached_power get_cached_power_for_decimal(const int exponent)noexcept
+{
+    return cached_powers()[(exponent - min_cached_exponent) / cached_step];
+}
+
+
+// step the last digit of buffer down while that moves it closer to w, then
+// check that no other shortest candidate is as close. false if the imprecision
+// of the scaled values leaves that undecided
+inline bool round_weed(char* buffer, const int length, const std::uint64_t distance_too_high_w,
+                       const std::uint64_t unsafe_interval, std::uint64_t rest,
+                       const std::uint64_t ten_kappa, const std::uint64_t unit)noexcept
+{
+    const std::uint64_t small_distance = distance_too_high_w - unit;
+    const std::uint64_t big_distance = distance_too_high_w + unit;
+
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+           (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance))
+    {
+        --buffer[length - 1];
+        rest += ten_kappa;
+    }
+
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+        (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance))
+    {
+        return false;
+    }
+
+    return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+// the shortest digits of a number in (low, high) closest to w, all scaled by
+// the same cached power, value = digits * 10^kappa
+inline bool digit_gen(const diy_fp& low, const diy_fp& w, const diy_fp& high,
+                      char* buffer, int& length, int& kappa)noexcept
+{
+    static const std::uint32_t powers_of_ten[] =
+    {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+
+    // the scaled boundaries are off by at most one unit
+    std::uint64_t unit = 1;
+    const diy_fp too_low(low.f - unit, low.e);
+    const diy_fp too_high(high.f + unit, high.e);
+    std::uint64_t unsafe_interval = diy_fp::minus(too_high, too_low).f;
+
+    const int shift = -w.e;
+    const diy_fp one(std::uint64_t(1) << shift, w.e);
+    std::uint32_t integrals = static_cast<std::uint32_t>(too_high.f >> shift);
+    std::uint64_t fractionals = too_high.f & (one.f - 1);
+
+    // integrals >= 8, as too_high is normalized and shift <= 60
+    kappa = 10;
+    while (integrals < powers_of_ten[kappa - 1])
+    {
+        --kappa;
+    }
+    std::uint32_t divisor = powers_of_ten[kappa - 1];
+
+    length = 0;
+    while (kappa > 0)
+    {
+        buffer[length++] = static_cast<char>('0' + integrals / divisor);
+        integrals %= divisor;
+        --kappa;
+
+        const std::uint64_t rest = (static_cast<std::uint64_t>(integrals) << shift) + fractionals;
+        if (rest < unsafe_interval)
+        {
+            return round_weed(buffer, length, diy_fp::minus(too_high, w).f, unsafe_interval,
+                              rest, static_cast<std::uint64_t>(divisor) << shift, unit);
+        }
+        divisor /= 10;
+    }
+
+    while (true)
+    {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+
+        buffer[length++] = static_cast<char>('0' + (fractionals >> shift));
+        fractionals &= one.f - 1;
+        --kappa;
+
+        if (fractionals < unsafe_interval)
+        {
+            return round_weed(buffer, length, diy_fp::minus(too_high, w).f * unit, unsafe_interval,
+                              fractionals, one.f, unit);
+        }
+    }
+}
+
+// a positive finite float, value = digits * 10^decimal_exponent
+template<typename FloatType>
+bool grisu3(const FloatType value, char* buffer, int& length, int& decimal_exponent)noexcept
+{
+    const boundaries b = compute_boundaries(value);
+    const cached_power cached = get_cached_power(b.plus.e);
+    const diy_fp c(cached.f, cached.e);
+
+    const diy_fp w = diy_fp::times(b.w, c);
+    const diy_fp minus = diy_fp::times(b.minus, c);
+    const diy_fp plus = diy_fp::times(b.plus, c);
+
+    int kappa = 0;
+    if (!digit_gen(minus, w, plus, buffer, length, kappa))
+    {
+        return false;
+    }
+    decimal_exponent = kappa - cached.k;
+    return true;
+}
+
+
+inline float parse_back(const char* text, float*)              { return std::strtof(text, nullptr);    }
+inline double parse_back(const char* text, double*)            { return std::strtod(text, nullptr);    }
+inline long double parse_back(const char* text, long double*)  { return std::strtold(text, nullptr);   }
+
+// the first precision whose correctly rounded digits parse back, the buffer
+// holds at least max_digits10 characters
+template<typename FloatType>
+void shortest_by_printing(const FloatType value, char* buffer, int& length, int& decimal_exponent)
+{
+    char text[64];
+    for (int precision = 1; ; ++precision)
+    {
+        std::snprintf(text, sizeof(text), "%.*Le", precision - 1, static_cast<long double>(value));
+        if (parse_back(text, static_cast<FloatType*>(nullptr)) != value &&
+            precision < std::numeric_limits<FloatType>::max_digits10)
+        {
+            continue;
+        }
+
+        // d.ddde[+-]x, the decimal point may be any character of the locale
+        const char* pos = text;
+        length = 0;
+        for (; *pos != 'e'; ++pos)
+        {
+            if (*pos >= '0' && *pos <= '9')
+            {
+                buffer[length++] = *pos;
+            }
+        }
+        decimal_exponent = static_cast<int>(std::strtol(pos + 1, nullptr, 10)) - (length - 1);
+
+        while (length > 1 && buffer[length - 1] == '0')
+        {
+            --length;
+            ++decimal_exponent;
+        }
+        return;
+    }
+}
+
+template<typename FloatType>
+void shortest_digits(const FloatType value, char* buffer, int& length, int& decimal_exponent, std::true_type)
+{
+    if (!grisu3(value, buffer, length, decimal_exponent))
+    {
+        shortest_by_printing(value, buffer, length, decimal_exponent);
+    }
+}
+
+template<typename FloatType>
+void shortest_digits(const FloatType value, char* buffer, int& length, int& decimal_exponent, std::false_type)
+{
+    shortest_by_printing(value, buffer, length, decimal_exponent);
+}
+
+
+// digits * 10^decimal_exponent, in the notation of printf's %g: fixed when the
+// exponent of the first digit is in [-4, fixed_limit), scientific otherwise,
+// and no trailing zeros
+inline char* format_digits(char* buffer, const int length, const int decimal_exponent, const int fixed_limit)noexcept
+{
+    const int exponent = length + decimal_exponent - 1;
+
+    if (exponent >= -4 && exponent < fixed_limit)
+    {
+        if (decimal_exponent >= 0)
+        {
+            // 1500
+            std::memset(buffer + length, '0', static_cast<std::size_t>(decimal_exponent));
+            return buffer + length + decimal_exponent;
+        }
+
+        if (exponent >= 0)
+        {
+            // 15.25
+            const int integral = exponent + 1;
+            std::memmove(buffer + integral + 1, buffer + integral, static_cast<std::size_t>(length - integral));
+            buffer[integral] = '.';
+            return buffer + length + 1;
+        }
+
+        // 0.0015
+        const int zeros = -exponent - 1;
+        std::memmove(buffer + 2 + zeros, buffer, static_cast<std::size_t>(length));
+        buffer[0] = '0';
+        buffer[1] = '.';
+        std::memset(buffer + 2, '0', static_cast<std::size_t>(zeros));
+        return buffer + 2 + zeros + length;
+    }
+
+    // 1.5e+20
+    char* pos = buffer + 1;
+    if (length > 1)
+    {
+        std::memmove(buffer + 2, buffer + 1, static_cast<std::size_t>(length - 1));
+        buffer[1] = '.';
+        pos = buffer + length + 1;
+    }
+
+    *pos++ = 'e';
+    *pos++ = exponent < 0 ? '-' : '+';
+    int magnitude = exponent < 0 ? -exponent : exponent;
+    if (magnitude >= 100)
+    {
+        *pos++ = static_cast<char>('0' + magnitude / 100);
+        magnitude %= 100;
+    }
+    *pos++ = static_cast<char>('0' + magnitude / 10);
+    *pos++ = static_cast<char>('0' + magnitude % 10);
+    return pos;
+}
+
+
+// the double nearest to significand * 10^exponent from 64-bit arithmetic and
+// a cached power, tracking the error in eighths of the last bit (DiyFpStrtod of
+// double-conversion). significand is nonzero, and rounded when truncated from
+// more digits. false if the error interval straddles a halfway point between
+// two doubles, the result is undecided then
+inline bool diy_fp_strtod(const std::uint64_t significand, const bool truncated, const int exponent, double& result)noexcept
+{
+    constexpr int denominator_log = 3;
+    constexpr std::uint64_t denominator = 1 << denominator_log;
+    constexpr int significand_size = 53;
+    constexpr int exponent_bias = 0x3FF + significand_size - 1;
+    constexpr int denormal_exponent = 1 - exponent_bias;
+    constexpr int max_exponent = 0x7FF - exponent_bias;
+    constexpr std::uint64_t hidden_bit = std::uint64_t(1) << (significand_size - 1);
+    constexpr std::uint64_t significand_mask = hidden_bit - 1;
+
+    if (exponent < min_cached_exponent || exponent >= max_cached_exponent + cached_step)
+    {
+        return false;
+    }
+
+    diy_fp input = diy_fp::normalize(diy_fp(significand, 0));
+    std::uint64_t error = truncated ? denominator / 2 : 0;
+    error <<= -input.e;
+
+    const cached_power cached = get_cached_power_for_decimal(exponent);
+    if (cached.k != exponent)
+    {
+        // 10^1 to 10^7 normalized, and the largest significand each keeps exact
+        static const diy_fp powers[] =
+        {
+            diy_fp(0xA000000000000000ull, -60), diy_fp(0xC800000000000000ull, -57), diy_fp(0xFA00000000000000ull, -54),
+            diy_fp(0x9C40000000000000ull, -50), diy_fp(0xC350000000000000ull, -47), diy_fp(0xF424000000000000ull, -44),
+            diy_fp(0x9896800000000000ull, -40)
+        };
+        constexpr std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+        static const std::uint64_t limits[] =
+        {
+            max / 10, max / 100, max / 1000, max / 10000, max / 100000, max / 1000000, max / 10000000
+        };
+
+        const int adjustment = exponent - cached.k - 1;
+        input = diy_fp::times(input, powers[adjustment]);
+        if (significand > limits[adjustment])
+        {
+            // the product did not fit in 64 bits
+            error += denominator / 2;
+        }
+    }
+
+    input = diy_fp::times(input, diy_fp(cached.f, cached.e));
+
+    // the cached power, the rounded product, and their product
+    error += denominator / 2 + (error == 0 ? 0 : 1) + denominator / 2;
+
+    const int old_e = input.e;
+    input = diy_fp::normalize(input);
+    error <<= old_e - input.e;
+
+    // the bits below the precision of the result, fewer for a denormal
+    const int magnitude = 64 + input.e;
+    int effective_size = significand_size;
+    if (magnitude <= denormal_exponent)
+    {
+        effective_size = 0;
+    }
+    else if (magnitude < denormal_exponent + significand_size)
+    {
+        effective_size = magnitude - denormal_exponent;
+    }
+
+    int precision_bits_count = 64 - effective_size;
+    if (precision_bits_count + denominator_log >= 64)
+    {
+        const int shift = precision_bits_count + denominator_log - 64 + 1;
+        input.f >>= shift;
+        input.e += shift;
+        error = (error >> shift) + 1 + denominator;
+        precision_bits_count -= shift;
+    }
+
+    const std::uint64_t precision_mask = (std::uint64_t(1) << precision_bits_count) - 1;
+    const std::uint64_t precision_bits = (input.f & precision_mask) * denominator;
+    const std::uint64_t half_way = (std::uint64_t(1) << (precision_bits_count - 1)) * denominator;
+    if (half_way - error < precision_bits && precision_bits < half_way + error)
+    {
+        return false;
+    }
+
+    std::uint64_t bits = input.f >> precision_bits_count;
+    int bits_exponent = input.e + precision_bits_count;
+    if (precision_bits >= half_way + error)
+    {
+        ++bits;
+    }
+
+    while (bits > hidden_bit + significand_mask)
+    {
+        bits >>= 1;
+        ++bits_exponent;
+    }
+
+    if (bits_exponent >= max_exponent)
+    {
+        result = std::numeric_limits<double>::infinity();
+        return true;
+    }
+    if (bits_exponent < denormal_exponent)
+    {
+        result = 0.0;
+        return true;
+    }
+
+    while (bits_exponent > denormal_exponent && (bits & hidden_bit) == 0)
+    {
+        bits <<= 1;
+        --bits_exponent;
+    }
+
+    const std::uint64_t biased_exponent = (bits_exponent == denormal_exponent && (bits & hidden_bit) == 0) ?
+        0 : static_cast<std::uint64_t>(bits_exponent + exponent_bias);
+    const std::uint64_t raw = (bits & significand_mask) | (biased_exponent << (significand_size - 1));
+    std::memcpy(&result, &raw, sizeof(result));
+    return true;
+}
+
+template<typename FloatType>
+bool approximate_strtod(std::uint64_t, bool, int, FloatType&, std::false_type)noexcept
+{
+    return false;
+}
+
+inline bool approximate_strtod(const std::uint64_t significand, const bool truncated, const int exponent,
+                               double& result, std::true_type)noexcept
+{
+    return diy_fp_strtod(significand, truncated, exponent, result);
+}
+
+
+// 10^exponent is exact in FloatType up to this exponent, 0 if not known
+template<typename FloatType>
+constexpr int max_exact_power()noexcept
+{
+    return std::numeric_limits<FloatType>::digits == 53 ? 22 : (std::numeric_limits<FloatType>::digits == 24 ? 10 : 0);
+}
+
+
+} // namespace dtoa
+
+
+// the number of significant decimal digits make_float() takes as an integer
+constexpr std::size_t max_significand_digits = 19;
+
+// the nearest FloatType to d * 10^exponent, where d are the significant decimal
+// digits of a number. significand holds the first max_significand_digits of
+// them, and digits all of them when there are more, length is 0 otherwise.
+//
+// a significand and a power of ten that are both exact give it with one
+// multiplication or division (Clinger's fast path), a double is then
+// approximated with a cached power, and whatever is still undecided goes
+// through strto*. the text has no decimal point so the locale does not matter
+template<typename FloatType>
+FloatType make_float(std::uint64_t significand, int exponent, const char* digits = nullptr, const std::size_t length = 0)
+{
+    if (significand == 0)
+    {
+        return FloatType(0);
+    }
+
+    const bool truncated = length > max_significand_digits;
+    if (truncated)
+    {
+        exponent += static_cast<int>(length - max_significand_digits);
+        if (digits[max_significand_digits] >= '5')
+        {
+            ++significand;
+        }
+    }
+    else
+    {
+        constexpr int max_power = dtoa::max_exact_power<FloatType>();
+        constexpr int exact_bits = std::numeric_limits<FloatType>::digits < 64 ? std::numeric_limits<FloatType>::digits : 63;
+        if (max_power > 0 && exponent >= -max_power && exponent <= max_power && (significand >> exact_bits) == 0)
+        {
+            static const FloatType powers[] =
+            {
+                FloatType(1e0),  FloatType(1e1),  FloatType(1e2),  FloatType(1e3),  FloatType(1e4),  FloatType(1e5),
+                FloatType(1e6),  FloatType(1e7),  FloatType(1e8),  FloatType(1e9),  FloatType(1e10), FloatType(1e11),
+                FloatType(1e12), FloatType(1e13), FloatType(1e14), FloatType(1e15), FloatType(1e16), FloatType(1e17),
+                FloatType(1e18), FloatType(1e19), FloatType(1e20), FloatType(1e21), FloatType(1e22)
+            };
+
+            const auto value = static_cast<FloatType>(significand);
+            return exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+        }
+    }
+
+    using double_type = std::integral_constant<bool, std::is_same<FloatType, double>::value &&
+        std::numeric_limits<double>::is_iec559>;
+
+    FloatType result;
+    if (dtoa::approximate_strtod(significand, truncated, exponent, result, double_type()))
+    {
+        return result;
+    }
+
+    char buffer[64];
+    if (!truncated)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%llue%d", static_cast<unsigned long long>(significand), exponent);
+        return dtoa::parse_back(buffer, static_cast<FloatType*>(nullptr));
+    }
+
+    // every digit, exponent was moved past the truncated ones
+    exponent -= static_cast<int>(length - max_significand_digits);
+    std::string text(digits, length);
+    std::snprintf(buffer, sizeof(buffer), "e%d", exponent);
+    text.append(buffer);
+    return dtoa::parse_back(text.c_str(), static_cast<FloatType*>(nullptr));
+}
+
+
+// writes at most float_buffer_size characters, a NaN or an infinity as null,
+// which is the closest JSON has. returns the end of the text
+constexpr std::size_t float_buffer_size = 64;
+
+template<typename FloatType>
+char* format_float(char* first, FloatType value)
+{
+    if (!std::isfinite(value))
+    {
+        std::memcpy(first, "null", 4);
+        return first + 4;
+    }
+
+    if (value == 0)
+    {
+        // -0 would parse back as the integer 0, the sign is kept by writing it as a float
+        if (std::signbit(value))
+        {
+            std::memcpy(first, "-0.0", 4);
+            return first + 4;
+        }
+        *first++ = '0';
+        return first;
+    }
+
+    if (value < 0)
+    {
+        *first++ = '-';
+        value = -value;
+    }
+
+    using grisu_type = std::integral_constant<bool, std::numeric_limits<FloatType>::is_iec559 &&
+        (std::numeric_limits<FloatType>::digits == 24 || std::numeric_limits<FloatType>::digits == 53)>;
+
+    int length = 0;
+    int decimal_exponent = 0;
+    dtoa::shortest_digits(value, first, length, decimal_exponent, grisu_type());
+    return dtoa::format_digits(first, length, decimal_exponent, std::numeric_limits<FloatType>::max_digits10 - 2);
+}
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_FLOAT_HPP
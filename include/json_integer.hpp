@@ -0,0 +1,139 @@
+#ifndef JSON_INTEGER_HPP
+#define JSON_INTEGER_HPP
+
+#include <cstddef>      // size_t
+#include <cstring>      // memcpy
+#include <limits>       // numeric_limits
+#include <type_traits>  // is_signed, is_unsigned, make_unsigned
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// format_integer, the decimal text of an integer written into a buffer.
+//
+// the digit count is found first with a few compares, so the text is written
+// backwards from its end straight into place, two digits per division by 100
+// from a table of the pairs 00 to 99. values below 100 skip all of that
+//
+
+// at least the characters of the longest IntegerType, sign included
+template<typename IntegerType>
+constexpr std::size_t integer_buffer_size()
+{
+    return static_cast<std::size_t>(std::numeric_limits<IntegerType>::digits10) + 2;
+}
+
+inline const char* digit_pairs()noexcept
+{
+    static const char pairs[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    return pairs;
+}
+
+// value != 0 has at least one digit, four are counted per division
+template<typename UnsignedType>
+unsigned int decimal_digits(UnsignedType value)noexcept
+{
+    static_assert(std::is_unsigned<UnsignedType>::value, "decimal_digits takes an unsigned type");
+
+    unsigned int count = 1;
+    while (true)
+    {
+        if (value < 10u)    return count;
+        if (value < 100u)   return count + 1;
+        if (value < 1000u)  return count + 2;
+        if (value < 10000u) return count + 3;
+        value /= 10000u;
+        count += 4;
+    }
+}
+
+// writes integer_buffer_size<UnsignedType>() characters at most, returns the end of the text
+template<typename UnsignedType>
+char* format_unsigned(char* first, UnsignedType value)noexcept
+{
+    static_assert(std::is_unsigned<UnsignedType>::value, "format_unsigned takes an unsigned type");
+
+    const char* pairs = digit_pairs();
+    if (value < 10u)
+    {
+        *first = static_cast<char>('0' + value);
+        return first + 1;
+    }
+    if (value < 100u)
+    {
+        std::memcpy(first, pairs + value * 2, 2);
+        return first + 2;
+    }
+
+    char* const last = first + decimal_digits(value);
+    char* iter = last;
+    while (value >= 100u)
+    {
+        const auto index = static_cast<std::size_t>(value % 100u) * 2;
+        value /= 100u;
+        iter -= 2;
+        std::memcpy(iter, pairs + index, 2);
+    }
+
+    if (value < 10u)
+    {
+        *--iter = static_cast<char>('0' + value);
+    }
+    else
+    {
+        iter -= 2;
+        std::memcpy(iter, pairs + static_cast<std::size_t>(value) * 2, 2);
+    }
+    return last;
+}
+
+// the magnitude of the lowest value is taken in the unsigned type, so it does not overflow
+template<typename IntegerType>
+char* format_integer(char* first, const IntegerType value)noexcept
+{
+    static_assert(std::is_signed<IntegerType>::value, "format_integer takes a signed type");
+    using unsigned_type = typename std::make_unsigned<IntegerType>::type;
+
+    if (value < 0)
+    {
+        *first++ = '-';
+        return format_unsigned(first, static_cast<unsigned_type>(unsigned_type(0) - static_cast<unsigned_type>(value)));
+    }
+    return format_unsigned(first, static_cast<unsigned_type>(value));
+}
+
+// the number of characters format_integer writes
+template<typename IntegerType>
+std::size_t integer_size(const IntegerType value)noexcept
+{
+    static_assert(std::is_signed<IntegerType>::value, "integer_size takes a signed type");
+    using unsigned_type = typename std::make_unsigned<IntegerType>::type;
+
+    if (value < 0)
+    {
+        return 1 + decimal_digits(static_cast<unsigned_type>(unsigned_type(0) - static_cast<unsigned_type>(value)));
+    }
+    return decimal_digits(static_cast<unsigned_type>(value));
+}
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_INTEGER_HPP
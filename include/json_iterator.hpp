@@ -3,7 +3,9 @@
 
 #include <cstddef>
 #include <iterator>
+#include <type_traits>
 #include "json_value.hpp"
+#include "json_string_view.hpp"
 #include "json_exception.hpp"
 
 namespace sjson
@@ -98,9 +100,19 @@ template<typename BasicJsonType>
 class internal_iterator
 {
 public:
-    typename BasicJsonType::object_t::iterator  object_iter{ };
-    typename BasicJsonType::array_t::iterator   array_iter{ };
-    primitive_iterator                          original_iter{ };  // for other types
+    using object_t  = typename BasicJsonType::object_t;
+    using array_t   = typename BasicJsonType::array_t;
+
+    using object_iterator = typename std::conditional<std::is_const<BasicJsonType>::value,
+        typename object_t::const_iterator, typename object_t::iterator>::type;
+    using array_iterator = typename std::conditional<std::is_const<BasicJsonType>::value,
+        typename array_t::const_iterator, typename array_t::iterator>::type;
+
+public:
+    object_iterator     object_iter{ };
+    array_iterator      array_iter{ };
+    primitive_iterator  original_iter{ };  // for other types
+    std::size_t         packed_index = 0;   // for a packed array read through a const iterator
 };
 
 
@@ -132,6 +144,8 @@ public:
     explicit iterator_impl(pointer json) : m_json(json) { }
 
 
+    // an element of a packed array is copied into the iterator, the reference
+    // is valid until the iterator is changed or destroyed
     const_pointer operator->()const
     {
         check_data();
@@ -142,6 +156,11 @@ public:
         case value_t::object:
             return &(m_iter.object_iter->second);
         case value_t::array:
+            if (packed())
+            {
+                m_json->m_value.element_at(m_iter.packed_index, m_element.m_value);
+                return &m_element;
+            }
             return &(*m_iter.array_iter);
         default:
             return m_json;
@@ -176,6 +195,12 @@ public:
         return m_iter.object_iter->first;
     }
 
+    // a view of the key, nothing is copied
+    basic_string_view<char_type> key_view()const
+    {
+        return basic_string_view<char_type>(static_cast<const string_t&>(key()));
+    }
+
     const_reference value()const
     {
         return operator*();
@@ -189,13 +214,18 @@ public:
         {
         case value_t::object:
         {
-            m_iter.object_iter = m_json->m_value.m_data.object->begin();
+            m_iter.object_iter = m_json->m_value.object_value().begin();
             break;
         }
 
         case value_t::array:
         {
-            m_iter.array_iter = m_json->m_value.m_data.array->begin();
+            if (packed())
+            {
+                m_iter.packed_index = 0;
+                break;
+            }
+            m_iter.array_iter = m_json->m_value.array_value().begin();
             break;
         }
 
@@ -215,13 +245,18 @@ public:
         {
         case value_t::object:
         {
-            m_iter.object_iter = m_json->m_value.m_data.object->end();
+            m_iter.object_iter = m_json->m_value.object_value().end();
             break;
         }
 
         case value_t::array:
         {
-            m_iter.array_iter = m_json->m_value.m_data.array->end();
+            if (packed())
+            {
+                m_iter.packed_index = m_json->m_value.array_size();
+                break;
+            }
+            m_iter.array_iter = m_json->m_value.array_value().end();
             break;
         }
 
@@ -248,6 +283,11 @@ public:
 
         case value_t::array:
         {
+            if (packed())
+            {
+                ++m_iter.packed_index;
+                break;
+            }
             std::advance(m_iter.array_iter, 1);
             break;
         }
@@ -283,6 +323,11 @@ public:
 
         case value_t::array:
         {
+            if (packed())
+            {
+                --m_iter.packed_index;
+                break;
+            }
             std::advance(m_iter.array_iter, -1);
             break;
         }
@@ -332,6 +377,11 @@ public:
 
         case value_t::array:
         {
+            if (packed())
+            {
+                m_iter.packed_index += off;
+                break;
+            }
             std::advance(m_iter.array_iter, off);
             break;
         }
@@ -372,6 +422,10 @@ public:
 
         case value_t::array:
         {
+            if (packed())
+            {
+                return m_iter.packed_index == other.m_iter.packed_index;
+            }
             return m_iter.array_iter == other.m_iter.array_iter;
         }
 
@@ -407,6 +461,10 @@ public:
 
         case value_t::array:
         {
+            if (packed())
+            {
+                return m_iter.packed_index < other.m_iter.packed_index;
+            }
             return m_iter.array_iter < other.m_iter.array_iter;
         }
 
@@ -434,6 +492,12 @@ public:
 
 
 private:
+    // a const iterator reads a packed array in place, a mutable one unpacks it in set_begin() or set_end()
+    bool packed()const noexcept
+    {
+        return std::is_const<BasicJsonType>::value && m_json->m_value.is_packed();
+    }
+
     void check_data()const
     {
         if (m_json == nullptr)
@@ -448,7 +512,7 @@ private:
         {
         case value_t::object:
         {
-            if (m_iter.object_iter == m_json->m_value.m_data.object->end())
+            if (m_iter.object_iter == m_json->m_value.object_value().end())
             {
                 throw std::out_of_range("iterator out of range");
             }
@@ -457,7 +521,8 @@ private:
 
         case value_t::array:
         {
-            if (m_iter.array_iter == m_json->m_value.m_data.array->end())
+            if (packed() ? m_iter.packed_index >= m_json->m_value.array_size() :
+                m_iter.array_iter == m_json->m_value.array_value().end())
             {
                 throw std::out_of_range("iterator out of range");
             }
@@ -476,8 +541,63 @@ private:
     }
 
 private:
+    using element_type = typename std::remove_const<BasicJsonType>::type;
+
     pointer                             m_json;
     internal_iterator<BasicJsonType>    m_iter;
+    mutable element_type                m_element;  // the packed element last read
+};
+
+
+
+//
+// json_reverse_iterator, std::reverse_iterator keeping the iterator it reads
+// through, since an iterator of a packed array hands out references into itself
+//
+template<typename Base>
+class json_reverse_iterator : public std::reverse_iterator<Base>
+{
+public:
+    using base_iterator     = std::reverse_iterator<Base>;
+    using difference_type   = typename base_iterator::difference_type;
+    using reference         = typename Base::reference;
+    using pointer           = typename Base::pointer;
+
+public:
+    explicit json_reverse_iterator(const Base& it) : base_iterator(it), m_current(it) { }
+
+    json_reverse_iterator(const base_iterator& it) : base_iterator(it), m_current(it.base()) { }
+
+    reference operator*()const
+    {
+        m_current = this->base();
+        --m_current;
+        return *m_current;
+    }
+
+    pointer operator->()const
+    {
+        return &operator*();
+    }
+
+    reference operator[](const difference_type off)const
+    {
+        m_current = this->base();
+        m_current -= off + 1;
+        return *m_current;
+    }
+
+    json_reverse_iterator& operator++()                         { base_iterator::operator++(); return *this;     }
+    json_reverse_iterator operator++(int)                       { return base_iterator::operator++(0);            }
+    json_reverse_iterator& operator--()                         { base_iterator::operator--(); return *this;     }
+    json_reverse_iterator operator--(int)                       { return base_iterator::operator--(0);            }
+    json_reverse_iterator& operator+=(const difference_type off) { base_iterator::operator+=(off); return *this;  }
+    json_reverse_iterator& operator-=(const difference_type off) { base_iterator::operator-=(off); return *this;  }
+    json_reverse_iterator operator+(const difference_type off)const { return base_iterator::operator+(off);       }
+    json_reverse_iterator operator-(const difference_type off)const { return base_iterator::operator-(off);       }
+
+private:
+    mutable Base    m_current;
 };
 
 } // namespace detail
@@ -0,0 +1,167 @@
+#ifndef JSON_MEMORY_HPP
+#define JSON_MEMORY_HPP
+
+#include <atomic>       // atomic
+#include <cstddef>      // size_t
+#include "json_utils.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_memory_usage, the heap bytes held by a document, see basic_json::memory_usage().
+// object entries of a container without capacity() (std::map) are counted as the
+// entry plus a tree node header of four pointers, the rest is exact for the
+// allocator policy in use, apart from the bookkeeping of the global heap
+//
+struct json_memory_usage
+{
+    std::size_t nodes       = 0;    // json_node blocks of objects, arrays, strings and boxed numbers
+    std::size_t strings     = 0;    // buffers of string values and big integers beyond the inline one
+    std::size_t keys        = 0;    // buffers of object keys beyond the inline one, 0 for interned keys
+    std::size_t elements    = 0;    // storage of array elements and object entries in use
+    std::size_t slack       = 0;    // storage reserved by arrays and objects but not in use, and packed array views
+
+    std::size_t objects     = 0;
+    std::size_t arrays      = 0;    // packed ones included
+    std::size_t string_count = 0;   // string values, keys are not counted
+
+    std::size_t total()const noexcept
+    {
+        return nodes + strings + keys + elements + slack;
+    }
+
+    json_memory_usage& operator+=(const json_memory_usage& other)noexcept
+    {
+        nodes += other.nodes;
+        strings += other.strings;
+        keys += other.keys;
+        elements += other.elements;
+        slack += other.slack;
+        objects += other.objects;
+        arrays += other.arrays;
+        string_count += other.string_count;
+        return *this;
+    }
+};
+
+
+
+//
+// json_allocation_stats, the nodes allocated through json_value::create under
+// SJSON_MEMORY_STATS, all zero without it
+//
+class json_allocation_stats
+{
+public:
+    struct counters
+    {
+        std::size_t allocations     = 0;
+        std::size_t deallocations   = 0;
+        std::size_t bytes_allocated = 0;
+        std::size_t bytes_freed     = 0;
+
+        std::size_t live_nodes()const noexcept  { return allocations - deallocations;   }
+        std::size_t live_bytes()const noexcept  { return bytes_allocated - bytes_freed; }
+    };
+
+public:
+    static counters get()noexcept
+    {
+        const auto& values = shared();
+        counters result;
+        result.allocations = values.allocations.load(std::memory_order_relaxed);
+        result.deallocations = values.deallocations.load(std::memory_order_relaxed);
+        result.bytes_allocated = values.bytes_allocated.load(std::memory_order_relaxed);
+        result.bytes_freed = values.bytes_freed.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    static void reset()noexcept
+    {
+        auto& values = shared();
+        values.allocations.store(0, std::memory_order_relaxed);
+        values.deallocations.store(0, std::memory_order_relaxed);
+        values.bytes_allocated.store(0, std::memory_order_relaxed);
+        values.bytes_freed.store(0, std::memory_order_relaxed);
+    }
+
+    static void record_allocate(const std::size_t bytes)noexcept
+    {
+#if defined(SJSON_MEMORY_STATS)
+        auto& values = shared();
+        values.allocations.fetch_add(1, std::memory_order_relaxed);
+        values.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+#else
+        (void)bytes;
+#endif
+    }
+
+    static void record_deallocate(const std::size_t bytes)noexcept
+    {
+#if defined(SJSON_MEMORY_STATS)
+        auto& values = shared();
+        values.deallocations.fetch_add(1, std::memory_order_relaxed);
+        values.bytes_freed.fetch_add(bytes, std::memory_order_relaxed);
+#else
+        (void)bytes;
+#endif
+    }
+
+private:
+    struct atomic_counters
+    {
+        std::atomic<std::size_t> allocations{ 0 };
+        std::atomic<std::size_t> deallocations{ 0 };
+        std::atomic<std::size_t> bytes_allocated{ 0 };
+        std::atomic<std::size_t> bytes_freed{ 0 };
+    };
+
+    static atomic_counters& shared()noexcept
+    {
+        static atomic_counters values;
+        return values;
+    }
+};
+
+
+
+//
+// allocation_size, the bytes an allocator policy really hands out for a request,
+// from its static block_size() if it has one (pool_allocator rounds up to a size
+// class), the request itself otherwise
+//
+template<typename Allocator, typename = void>
+struct has_block_size
+    : std::false_type
+{
+};
+
+template<typename Allocator>
+struct has_block_size<Allocator, void_t<decltype(Allocator::block_size(std::size_t()))>>
+    : std::true_type
+{
+};
+
+template<typename Allocator>
+inline std::size_t allocation_size(const std::size_t bytes, std::true_type)     { return Allocator::block_size(bytes); }
+
+template<typename Allocator>
+inline std::size_t allocation_size(const std::size_t bytes, std::false_type)    { return bytes; }
+
+template<typename Allocator>
+inline std::size_t allocation_size(const std::size_t bytes)
+{
+    return allocation_size<Allocator>(bytes, has_block_size<Allocator>());
+}
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_MEMORY_HPP
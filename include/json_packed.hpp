@@ -0,0 +1,360 @@
+#ifndef JSON_PACKED_HPP
+#define JSON_PACKED_HPP
+
+#include <algorithm>    // equal
+#include <atomic>       // atomic
+#include <cstddef>      // size_t
+#include <memory>       // unique_ptr
+#include <vector>       // vector
+#include <stdexcept>    // out_of_range
+#include "json_value.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_span, a non-owning view of contiguous elements that also works in C++11
+//
+template<typename Ty>
+class json_span
+{
+public:
+    using element_type      = Ty;
+    using size_type         = std::size_t;
+    using pointer           = Ty*;
+    using reference         = Ty&;
+    using iterator          = Ty*;
+
+public:
+    constexpr json_span()noexcept : m_data(nullptr), m_size(0) { }
+
+    constexpr json_span(pointer data, size_type size)noexcept : m_data(data), m_size(size) { }
+
+    constexpr pointer data()const noexcept      { return m_data;        }
+    constexpr size_type size()const noexcept    { return m_size;        }
+    constexpr bool empty()const noexcept        { return m_size == 0;   }
+
+    constexpr iterator begin()const noexcept    { return m_data;            }
+    constexpr iterator end()const noexcept      { return m_data + m_size;   }
+
+    reference operator[](size_type index)const noexcept { return m_data[index]; }
+
+    reference at(size_type index)const
+    {
+        if (index >= m_size)
+        {
+            throw std::out_of_range("json_span index out of range");
+        }
+
+        return m_data[index];
+    }
+
+private:
+    pointer     m_data;
+    size_type   m_size;
+};
+
+
+
+//
+// json_packed_array, the storage of an array whose elements are all integers,
+// all floats or all booleans. only the vector of element_type() is used.
+//
+// const access that hands out a reference to an element reads it from a view:
+// element() builds the elements as general values view_chunk_size at a time,
+// array_view() the whole ArrayType. views are built on first use and published
+// with a compare-exchange, so concurrent readers are safe, and dropped by any
+// change of the elements. a copy starts without them
+//
+template<typename IntegerType, typename FloatType, typename BooleanType, typename ArrayType>
+class json_packed_array
+{
+public:
+    using size_type     = std::size_t;
+    using value_type    = typename ArrayType::value_type;
+
+    static constexpr size_type view_chunk_size = 64;
+
+public:
+    explicit json_packed_array(const value_t type) : m_type(type) { }
+
+    json_packed_array(const json_packed_array& other)
+        : m_type(other.m_type), m_integers(other.m_integers), m_floats(other.m_floats), m_booleans(other.m_booleans)
+    {
+    }
+
+    json_packed_array& operator=(const json_packed_array&) = delete;
+
+    ~json_packed_array()
+    {
+        clear_views();
+    }
+
+    value_t element_type()const noexcept    { return m_type; }
+
+    size_type size()const noexcept
+    {
+        switch (m_type)
+        {
+            case value_t::number_integer:   return m_integers.size();
+            case value_t::number_float:     return m_floats.size();
+            case value_t::boolean:          return m_booleans.size();
+            default:                        return 0;
+        }
+    }
+
+    bool empty()const noexcept  { return size() == 0; }
+
+    size_type capacity()const noexcept
+    {
+        switch (m_type)
+        {
+            case value_t::number_integer:   return m_integers.capacity();
+            case value_t::number_float:     return m_floats.capacity();
+            case value_t::boolean:          return m_booleans.capacity();
+            default:                        return 0;
+        }
+    }
+
+    void reserve(const size_type count)
+    {
+        switch (m_type)
+        {
+            case value_t::number_integer:   m_integers.reserve(count);  break;
+            case value_t::number_float:     m_floats.reserve(count);    break;
+            case value_t::boolean:          m_booleans.reserve(count);  break;
+            default:                        break;
+        }
+    }
+
+    void shrink_to_fit()
+    {
+        switch (m_type)
+        {
+            case value_t::number_integer:   m_integers.shrink_to_fit(); break;
+            case value_t::number_float:     m_floats.shrink_to_fit();   break;
+            case value_t::boolean:          m_booleans.shrink_to_fit(); break;
+            default:                        break;
+        }
+    }
+
+    // Ty is IntegerType, FloatType or BooleanType
+    template<typename Ty>
+    bool holds()const noexcept                      { return m_type == type_of(static_cast<const Ty*>(nullptr)); }
+
+    template<typename Ty>
+    const std::vector<Ty>& elements()const noexcept { return values(static_cast<const Ty*>(nullptr)); }
+
+    // append an element, false if its type is not element_type()
+    bool push_back(const IntegerType num)   { return push(m_integers, value_t::number_integer, num);   }
+    bool push_back(const FloatType num)     { return push(m_floats, value_t::number_float, num);        }
+    bool push_back(const BooleanType val)   { return push(m_booleans, value_t::boolean, val);           }
+
+    void pop_back()
+    {
+        clear_views();
+        switch (m_type)
+        {
+            case value_t::number_integer:   m_integers.pop_back();  break;
+            case value_t::number_float:     m_floats.pop_back();    break;
+            case value_t::boolean:          m_booleans.pop_back();  break;
+            default:                        break;
+        }
+    }
+
+    // append every element to a general array
+    template<typename GeneralArray>
+    void unpack_to(GeneralArray& array)const
+    {
+        array.reserve(array.size() + size());
+        switch (m_type)
+        {
+            case value_t::number_integer:
+                array.insert(array.end(), m_integers.begin(), m_integers.end());
+                break;
+
+            case value_t::number_float:
+                array.insert(array.end(), m_floats.begin(), m_floats.end());
+                break;
+
+            case value_t::boolean:
+                for (const bool val : m_booleans)
+                {
+                    array.emplace_back(static_cast<BooleanType>(val));
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // element index as a general value, index < size()
+    const value_type& element(const size_type index)const
+    {
+        auto chunks = m_chunks.load(std::memory_order_acquire);
+        if (chunks == nullptr)
+        {
+            std::unique_ptr<std::atomic<value_type*>[]> directory(new std::atomic<value_type*>[chunk_count()]());
+            chunks = publish(m_chunks, directory);
+        }
+
+        auto& chunk = chunks[index / view_chunk_size];
+        auto elements = chunk.load(std::memory_order_acquire);
+        if (elements == nullptr)
+        {
+            const size_type first = index / view_chunk_size * view_chunk_size;
+            const size_type count = chunk_length(first);
+            std::unique_ptr<value_type[]> built(new value_type[count]);
+            for (size_type i = 0; i < count; ++i)
+            {
+                built[i] = make_element(first + i);
+            }
+            elements = publish(chunk, built);
+        }
+        return elements[index % view_chunk_size];
+    }
+
+    // every element as a general array
+    const ArrayType& array_view()const
+    {
+        auto view = m_array.load(std::memory_order_acquire);
+        if (view == nullptr)
+        {
+            std::unique_ptr<ArrayType> built(new ArrayType);
+            unpack_to(*built);
+            view = publish(m_array, built);
+        }
+        return *view;
+    }
+
+    // the bytes of the views built so far
+    size_type view_size()const noexcept
+    {
+        size_type bytes = 0;
+        if (const auto view = m_array.load(std::memory_order_acquire))
+        {
+            bytes += sizeof(ArrayType) + view->capacity() * sizeof(value_type);
+        }
+        if (const auto chunks = m_chunks.load(std::memory_order_acquire))
+        {
+            bytes += chunk_count() * sizeof(std::atomic<value_type*>);
+            for (size_type chunk = 0; chunk < chunk_count(); ++chunk)
+            {
+                if (chunks[chunk].load(std::memory_order_acquire) != nullptr)
+                {
+                    bytes += chunk_length(chunk * view_chunk_size) * sizeof(value_type);
+                }
+            }
+        }
+        return bytes;
+    }
+
+    friend bool operator==(const json_packed_array& lhs, const json_packed_array& rhs)
+    {
+        return lhs.m_type == rhs.m_type && lhs.m_integers == rhs.m_integers &&
+            equal_floats(lhs.m_floats, rhs.m_floats) && lhs.m_booleans == rhs.m_booleans;
+    }
+
+private:
+    // NaN equals NaN, as for json values
+    static bool equal_floats(const std::vector<FloatType>& lhs, const std::vector<FloatType>& rhs)noexcept
+    {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+            [](const FloatType lhs_val, const FloatType rhs_val) { return lhs_val == rhs_val || (lhs_val != lhs_val && rhs_val != rhs_val); });
+    }
+
+    static value_t type_of(const IntegerType*)noexcept  { return value_t::number_integer;   }
+    static value_t type_of(const FloatType*)noexcept    { return value_t::number_float;     }
+    static value_t type_of(const BooleanType*)noexcept  { return value_t::boolean;          }
+
+    const std::vector<IntegerType>& values(const IntegerType*)const noexcept    { return m_integers;    }
+    const std::vector<FloatType>&   values(const FloatType*)const noexcept      { return m_floats;      }
+    const std::vector<BooleanType>& values(const BooleanType*)const noexcept    { return m_booleans;    }
+
+    template<typename Ty>
+    bool push(std::vector<Ty>& vec, const value_t type, const Ty val)
+    {
+        if (m_type != type)
+        {
+            return false;
+        }
+
+        clear_views();
+        vec.push_back(val);
+        return true;
+    }
+
+    value_type make_element(const size_type index)const
+    {
+        switch (m_type)
+        {
+            case value_t::number_integer:   return value_type(m_integers[index]);
+            case value_t::number_float:     return value_type(m_floats[index]);
+            default:                        return value_type(static_cast<BooleanType>(m_booleans[index]));
+        }
+    }
+
+    size_type chunk_count()const noexcept
+    {
+        return (size() + view_chunk_size - 1) / view_chunk_size;
+    }
+
+    // the elements of the chunk that starts at first
+    size_type chunk_length(const size_type first)const noexcept
+    {
+        const size_type rest = size() - first;
+        if (rest < view_chunk_size)
+        {
+            return rest;
+        }
+        return view_chunk_size;
+    }
+
+    // stores built unless another thread was first, the one stored is returned
+    template<typename Ptr>
+    static typename Ptr::pointer publish(std::atomic<typename Ptr::pointer>& slot, Ptr& built)noexcept
+    {
+        typename Ptr::pointer stored = nullptr;
+        if (slot.compare_exchange_strong(stored, built.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return built.release();
+        }
+        return stored;
+    }
+
+    // before the elements change, while no reader can see them
+    void clear_views()noexcept
+    {
+        delete m_array.exchange(nullptr, std::memory_order_relaxed);
+
+        if (const auto chunks = m_chunks.exchange(nullptr, std::memory_order_relaxed))
+        {
+            for (size_type chunk = 0; chunk < chunk_count(); ++chunk)
+            {
+                delete[] chunks[chunk].load(std::memory_order_relaxed);
+            }
+            delete[] chunks;
+        }
+    }
+
+private:
+    value_t                     m_type;
+    std::vector<IntegerType>    m_integers;
+    std::vector<FloatType>      m_floats;
+    std::vector<BooleanType>    m_booleans;
+
+    mutable std::atomic<ArrayType*>                 m_array{ nullptr };
+    mutable std::atomic<std::atomic<value_type*>*>  m_chunks{ nullptr };
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_PACKED_HPP
@@ -5,7 +5,13 @@
 #include <cctype>       // isdigit
 #include <ios>          // basic_istream, basic_streambuf
 #include <type_traits>  // char_traits
+#include <limits>       // numeric_limits
+#include <vector>       // vector
+#include <deque>        // deque
+#include <string>       // string
+#include <cstdint>      // uint64_t
 #include "json_exception.hpp"
+#include "json_float.hpp"
 
 namespace sjson
 {
@@ -144,6 +150,8 @@ enum class token_type
 
     value_string,
     value_integer,
+    value_unsigned,
+    value_big_integer,
     value_float,
 
     begin_object,
@@ -170,6 +178,7 @@ public:
     using array_t           = typename BasicJsonType::array_t;
     using string_t          = typename BasicJsonType::string_t;
     using number_integer_t  = typename BasicJsonType::number_integer_t;
+    using number_unsigned_t = typename BasicJsonType::number_unsigned_t;
     using number_float_t    = typename BasicJsonType::number_float_t;
     using boolean_t         = typename BasicJsonType::boolean_t;
     using char_type         = typename BasicJsonType::char_type;
@@ -443,8 +452,12 @@ public:
     token_type scan_number()
     {
         is_negative = false;
-        number_integer = static_cast<number_integer_t>(0);
+        is_overflow = false;
+        number_unsigned = static_cast<number_unsigned_t>(0);
         number_float = static_cast<number_float_t>(0.0);
+        float_significand = 0;
+        float_digit_count = 0;
+        float_exponent = 0;
 
         if (current == '-')
         {
@@ -476,13 +489,18 @@ public:
     {
         if (current == '0')
         {
-            if (read_next() == '.')
+            const auto ch = read_next();
+            if (ch == '.')
             {
                 return scan_float();
             }
+            else if (ch == 'e' || ch == 'E')
+            {
+                return scan_exponent();
+            }
             else
             {
-                return token_type::value_integer;
+                return integer_token();
             }
         }
 
@@ -493,30 +511,26 @@ public:
     {
         if (std::isdigit(current))
         {
-            number_integer = static_cast<number_integer_t>(current - '0');
+            number_unsigned = static_cast<number_unsigned_t>(current - '0');
 
             while (true)
             {
                 const auto ch = read_next();
                 if (ch == '.')
                 {
-                    number_float = static_cast<number_float_t>(number_integer);
-                    number_integer = 0;
-                    
+                    to_float();
                     return scan_float();
                 }
 
                 if (ch == 'e' || ch == 'E')
                 {
-                    number_float = static_cast<number_float_t>(number_integer);
-                    number_integer = 0;
-                    
+                    to_float();
                     return scan_exponent();
                 }
 
                 if (std::isdigit(ch))
                 {
-                    number_integer = number_integer * 10 + (ch - '0');
+                    push_digit(static_cast<unsigned int>(ch - '0'));
                 }
                 else
                 {
@@ -524,12 +538,140 @@ public:
                 }
             }
 
-            return token_type::value_integer;
+            return integer_token();
         }
 
         return token_type::parse_error;
     }
 
+    void push_digit(const unsigned int digit)
+    {
+        if (is_overflow)
+        {
+            string_buffer.push_back(static_cast<char_type>('0' + digit));
+            return;
+        }
+
+        const auto max = std::numeric_limits<number_unsigned_t>::max();
+        if (number_unsigned > (max - digit) / 10)
+        {
+            // keep the digits, the value does not fit in number_unsigned_t
+            is_overflow = true;
+            string_buffer.clear();
+            for (auto uval = number_unsigned; uval; uval /= 10)
+            {
+                string_buffer.insert(string_buffer.begin(), static_cast<char_type>('0' + uval % 10));
+            }
+            push_digit(digit);
+            return;
+        }
+
+        number_unsigned = number_unsigned * 10 + digit;
+    }
+
+    // the integer part of a float has been read, its digits start the significand
+    void to_float()
+    {
+        if (is_overflow)
+        {
+            for (const auto ch : string_buffer)
+            {
+                push_float_digit(static_cast<int>(ch));
+            }
+        }
+        else if (number_unsigned < max_significand)
+        {
+            float_significand = number_unsigned;
+            for (std::uint64_t power = 1; power <= number_unsigned; power *= 10)
+            {
+                ++float_digit_count;
+            }
+        }
+        else
+        {
+            char digits[std::numeric_limits<number_unsigned_t>::digits10 + 1];
+            std::size_t length = 0;
+            for (auto uval = number_unsigned; uval; uval /= 10)
+            {
+                digits[length++] = static_cast<char>('0' + uval % 10);
+            }
+            while (length)
+            {
+                push_float_digit(digits[--length]);
+            }
+        }
+        number_unsigned = 0;
+    }
+
+    // 10^max_significand_digits
+    static constexpr std::uint64_t max_significand = 10000000000000000000ull;
+
+    // the first max_significand_digits significant digits go to float_significand,
+    // all of them to float_digits beyond that
+    void push_float_digit(const int ch)
+    {
+        if (float_digit_count < max_significand_digits)
+        {
+            if (float_digit_count != 0 || ch != '0')
+            {
+                float_significand = float_significand * 10 + static_cast<std::uint64_t>(ch - '0');
+                ++float_digit_count;
+            }
+            return;
+        }
+
+        if (float_digit_count == max_significand_digits)
+        {
+            float_digits.resize(max_significand_digits);
+            auto uval = float_significand;
+            for (auto i = max_significand_digits; i > 0; --i, uval /= 10)
+            {
+                float_digits[i - 1] = static_cast<char>('0' + uval % 10);
+            }
+        }
+        float_digits.push_back(static_cast<char>(ch));
+        ++float_digit_count;
+    }
+
+    // the nearest number_float_t to the significand * 10^float_exponent
+    token_type float_token()
+    {
+        const auto length = float_digit_count > max_significand_digits ? float_digits.size() : 0;
+        number_float = make_float<number_float_t>(float_significand, float_exponent, float_digits.data(), length);
+        return token_type::value_float;
+    }
+
+    token_type integer_token()
+    {
+        if (is_overflow)
+        {
+#if defined(SJSON_BIG_INTEGERS)
+            return token_type::value_big_integer;
+#else
+            to_float();
+            return float_token();
+#endif
+        }
+
+        // the magnitude of the lowest number_integer_t is max + 1
+        const auto max = static_cast<number_unsigned_t>(std::numeric_limits<number_integer_t>::max());
+        if (number_unsigned <= max || (is_negative && number_unsigned - 1 <= max))
+        {
+            return token_type::value_integer;
+        }
+
+        if (!is_negative)
+        {
+            return token_type::value_unsigned;
+        }
+
+#if defined(SJSON_BIG_INTEGERS)
+        return token_type::value_big_integer;
+#else
+        return token_type::value_float;
+#endif
+    }
+
     token_type scan_float()
     {
         if (current != '.')
@@ -540,8 +682,8 @@ public:
         
         if (std::isdigit(read_next()))
         {
-            number_float_t fraction = static_cast<number_float_t>(0.1);
-            number_float += static_cast<number_float_t>(current - '0') * fraction;
+            push_float_digit(current);
+            --float_exponent;
 
             while (true)
             {
@@ -553,8 +695,8 @@ public:
 
                 if (std::isdigit(ch))
                 {
-                    fraction *= static_cast<number_float_t>(0.1);
-                    number_float += static_cast<number_float_t>(ch - '0') * fraction;
+                    push_float_digit(ch);
+                    --float_exponent;
                 }
                 else
                 {
@@ -562,7 +704,7 @@ public:
                 }
             }
 
-            return token_type::value_float;
+            return float_token();
         }
 
         return token_type::parse_error;
@@ -579,34 +721,30 @@ public:
 
         if ((std::isdigit(current) && current != '0') || (current == '-') || (current == '+'))
         {
-            number_float_t base = 10;
+            bool negative_exponent = false;
             if (current == '+')
             {
                 read_next();
             }
             else if (current == '-')
             {
-                base = static_cast<number_float_t>(0.1);
+                negative_exponent = true;
                 read_next();
             }
 
-            uint32_t exponect = static_cast<uint32_t>(current - '0');
+            // far beyond the range of any float, only the digits count then
+            const int max_exponent = 100000;
+            int exponent = static_cast<int>(current - '0');
             while (std::isdigit(read_next()))
             {
-                exponect = (exponect * 10) + static_cast<uint32_t>(current - '0');
-            }
-
-            number_float_t power = 1;
-            for (; exponect; exponect >>= 1, base *= base)
-            {
-                if (exponect & 1)
+                if (exponent < max_exponent)
                 {
-                    power *= base;
+                    exponent = (exponent * 10) + static_cast<int>(current - '0');
                 }
             }
 
-            number_float *= power;
-            return token_type::value_float;
+            float_exponent += negative_exponent ? -exponent : exponent;
+            return float_token();
         }
 
         return token_type::parse_error;
@@ -615,26 +753,77 @@ public:
 
     number_integer_t token_to_integer()const
     {
-        return is_negative ? -number_integer : number_integer;
+        if (is_negative)
+        {
+            // no overflow for the lowest number_integer_t
+            return number_unsigned == 0 ? 0 : -static_cast<number_integer_t>(number_unsigned - 1) - 1;
+        }
+
+        return static_cast<number_integer_t>(number_unsigned);
+    }
+
+    number_unsigned_t token_to_unsigned()const
+    {
+        return number_unsigned;
     }
 
     number_float_t token_to_float()const
     {
+        if (!is_overflow && number_unsigned != 0)
+        {
+            // an integer token out of the range of number_integer_t
+            const auto num = static_cast<number_float_t>(number_unsigned);
+            return is_negative ? -num : num;
+        }
+
         return is_negative ? -number_float : number_float;
     }
 
+    // the decimal text of an integer token out of range of the other types
+    string_t token_to_big_integer()const
+    {
+        string_t text;
+        if (is_negative)
+        {
+            text.push_back('-');
+        }
+
+        if (is_overflow)
+        {
+            text.append(string_buffer);
+        }
+        else
+        {
+            for (auto uval = number_unsigned; uval; uval /= 10)
+            {
+                text.insert(text.begin() + (is_negative ? 1 : 0), static_cast<char_type>('0' + uval % 10));
+            }
+        }
+        return text;
+    }
+
     string_t token_to_string()const
     {
         return string_buffer;
     }
 
+    const string_t& token_string()const
+    {
+        return string_buffer;
+    }
+
 
 private:
     input_adapter<char_type>&   adapter;
     int_type                    current = char_traits::eof();
     bool                        is_negative = false;
-    number_integer_t            number_integer = 0;
+    bool                        is_overflow = false;    // the digits are in string_buffer
+    number_unsigned_t           number_unsigned = 0;
     number_float_t              number_float = 0.0;
+    std::uint64_t               float_significand = 0;  // the leading digits of a float token
+    std::size_t                 float_digit_count = 0;  // its significant digits, leading zeros are not
+    std::string                 float_digits;           // all of them, past max_significand_digits
+    int                         float_exponent = 0;
     string_t                    string_buffer;
 };
 
@@ -642,6 +831,90 @@ private:
 
 
 
+//
+// json_dom_builder, the parser handler that builds a BasicJsonType
+//
+// a parser handler receives null_value(), boolean_value(), integer_value(),
+// unsigned_value(), big_integer_value(), float_value(), string_value(), key(),
+// begin_object(), end_object(), begin_array() and end_array() in document order
+//
+
+template<typename BasicJsonType>
+class json_dom_builder
+{
+public:
+    using string_t          = typename BasicJsonType::string_t;
+    using number_integer_t  = typename BasicJsonType::number_integer_t;
+    using number_unsigned_t = typename BasicJsonType::number_unsigned_t;
+    using number_big_integer_t = typename BasicJsonType::number_big_integer_t;
+    using number_float_t    = typename BasicJsonType::number_float_t;
+    using boolean_t         = typename BasicJsonType::boolean_t;
+
+public:
+    void null_value()                           { put(nullptr);             }
+    void boolean_value(const boolean_t val)     { put(val);                 }
+    void integer_value(const number_integer_t num) { put(num);              }
+    void unsigned_value(const number_unsigned_t num) { put(num);            }
+    void big_integer_value(const string_t& str) { put(number_big_integer_t(str)); }
+    void float_value(const number_float_t num)  { put(num);                 }
+    void string_value(const string_t& str)      { put(str);                 }
+    void string_value(string_t&& str)           { put(std::move(str));      }
+
+    void key(const string_t& str)               { object_key = str;         }
+    void key(string_t&& str)                    { object_key = std::move(str); }
+
+    void begin_object()     { stack.push_back(put(value_t::object));   }
+    void end_object()       { stack.pop_back();                        }
+    void begin_array()      { stack.push_back(put(value_t::array));    }
+    void end_array()        { stack.pop_back();                        }
+
+    BasicJsonType& result() { return root; }
+
+private:
+    template<typename Ty>
+    BasicJsonType* put(Ty&& val)
+    {
+        if (stack.empty())
+        {
+            root = BasicJsonType(std::forward<Ty>(val));
+            return &root;
+        }
+
+        auto& parent = stack.back()->m_value;
+        if (parent.type() == value_t::array)
+        {
+            if (parent.push_packed(val))
+            {
+                // scalars are never pushed on the stack
+                return nullptr;
+            }
+
+            auto& array = parent.modify_array();
+            array.emplace_back(std::forward<Ty>(val));
+            return &array.back();
+        }
+
+        auto result = parent.modify_object().emplace(std::move(object_key), BasicJsonType());
+        if (!result.second)
+        {
+            // duplicated key, the first one wins
+            discarded.emplace_back(std::forward<Ty>(val));
+            return &discarded.back();
+        }
+
+        result.first->second = BasicJsonType(std::forward<Ty>(val));
+        return &result.first->second;
+    }
+
+private:
+    BasicJsonType                   root;
+    std::vector<BasicJsonType*>     stack;
+    std::deque<BasicJsonType>       discarded;
+    string_t                        object_key;
+};
+
+
+
 //
 // json_parser
 //
@@ -665,13 +938,19 @@ public:
 
     BasicJsonType parse()
     {
-        auto json = parse_value();
+        json_dom_builder<BasicJsonType> builder;
+        parse(builder);
+        return std::move(builder.result());
+    }
+
+    template<typename Handler>
+    void parse(Handler& handler)
+    {
+        parse_value(handler);
         if (get_token() != token_type::end_of_input)
         {
             throw json_parse_error("unexpected token, expect end");
         }
-
-        return json;
     }
 
 private:
@@ -681,7 +960,8 @@ private:
         return last_token;
     }
 
-    BasicJsonType parse_value(bool get_next = true)
+    template<typename Handler>
+    void parse_value(Handler& handler, bool get_next = true)
     {
         token_type token = last_token;
         if (get_next)
@@ -692,26 +972,40 @@ private:
         switch (token)
         {
         case token_type::literal_null:
-            return nullptr;
+            handler.null_value();
+            return;
 
         case token_type::literal_true:
-            return true;
+            handler.boolean_value(true);
+            return;
 
         case token_type::literal_false:
-            return false;
+            handler.boolean_value(false);
+            return;
 
         case token_type::value_integer:
-            return lexer.token_to_integer();
+            handler.integer_value(lexer.token_to_integer());
+            return;
+
+        case token_type::value_unsigned:
+            handler.unsigned_value(lexer.token_to_unsigned());
+            return;
+
+        case token_type::value_big_integer:
+            handler.big_integer_value(lexer.token_to_big_integer());
+            return;
 
         case token_type::value_float:
-            return lexer.token_to_float();
+            handler.float_value(lexer.token_to_float());
+            return;
 
         case token_type::value_string:
-            return lexer.token_to_string();
+            handler.string_value(lexer.token_string());
+            return;
 
         case token_type::begin_object:
         {
-            auto json = BasicJsonType(value_t::object);
+            handler.begin_object();
             while (true)
             {
                 // {}, parse a empty object
@@ -727,14 +1021,14 @@ private:
                 }
 
                 // read key
-                string_t key = lexer.token_to_string();
+                handler.key(lexer.token_string());
                 if (get_token() != token_type::name_separator)
                 {
                     break;
                 }
 
-                // read value and insert pair
-                json.m_value.m_data.object->emplace(std::make_pair(key, parse_value()));
+                // read value
+                parse_value(handler);
 
                 // read ','
                 if (get_token() != token_type::value_separator)
@@ -748,12 +1042,13 @@ private:
                 throw json_parse_error("unexpected token in object");
             }
 
-            return json;
+            handler.end_object();
+            return;
         }
 
         case token_type::begin_array:
         {
-            auto json = BasicJsonType(value_t::array);
+            handler.begin_array();
             while (true)
             {
                 // [], parse a empty array
@@ -762,7 +1057,7 @@ private:
                     break;
                 }
 
-                json.m_value.m_data.array->push_back(parse_value(false));
+                parse_value(handler, false);
 
                 // read ','
                 if (get_token() != token_type::value_separator)
@@ -776,7 +1071,8 @@ private:
                 throw json_parse_error("unexpected token in array");
             }
 
-            return json;
+            handler.end_array();
+            return;
         }
 
         default:
@@ -0,0 +1,710 @@
+#ifndef JSON_PATCH_HPP
+#define JSON_PATCH_HPP
+
+#include <cstddef>      // size_t
+#include <vector>       // vector
+#include <utility>      // move
+#include <cstdint>      // uint8_t
+#include <type_traits>  // conditional, is_const
+#include <algorithm>    // lower_bound
+#include <unordered_map> // unordered_map
+#include "json_pointer.hpp"
+#include "json_exception.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_patch, applies a RFC 6902 JSON Patch or a RFC 7396 Merge Patch to a
+// document in place. values are moved, out of the document when removed and
+// out of the patch when it is an rvalue, nothing else is copied.
+// an atomic JSON Patch keeps an undo log of what each operation replaced or
+// removed, so a failure rolls back only what the patch had changed.
+// diff() produces the JSON Patch that turns one document into another
+//
+template<typename BasicJsonType>
+class json_patch
+{
+public:
+    using object_t  = typename BasicJsonType::object_t;
+    using array_t   = typename BasicJsonType::array_t;
+    using string_t  = typename BasicJsonType::string_t;
+    using pointer_t = json_pointer<BasicJsonType>;
+    using token_t   = typename pointer_t::token;
+    using char_type = typename BasicJsonType::char_type;
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+public:
+    // PatchType is BasicJsonType or const BasicJsonType
+    template<typename PatchType>
+    static void apply(BasicJsonType& document, PatchType& patch, const bool atomic)
+    {
+        if (!patch.is_array())
+        {
+            throw json_patch_error("json patch must be an array of operations");
+        }
+
+        auto& operations = patch.template get_ref<copy_const_t<PatchType, array_t>&>();
+
+        // every pointer is checked before the document is changed
+        std::vector<pointer_t> paths;
+        std::vector<pointer_t> froms;
+        paths.reserve(operations.size());
+        froms.reserve(operations.size());
+        for (const auto& operation : operations)
+        {
+            if (!operation.is_object() || !operation.contains("op") || !operation.contains("path"))
+            {
+                throw json_patch_error("json patch operation needs an \"op\" and a \"path\"");
+            }
+
+            paths.emplace_back(operation.at("path").as_string());
+            froms.emplace_back(operation.contains("from") ? pointer_t(operation.at("from").as_string()) : pointer_t());
+        }
+
+        json_patch patcher(document, atomic, operations.size());
+        try
+        {
+            for (size_type i = 0; i < operations.size(); ++i)
+            {
+                patcher.apply_operation(operations[i], paths[i], froms[i]);
+            }
+        }
+        catch (...)
+        {
+            patcher.rollback();
+            throw;
+        }
+    }
+
+    // null members of the patch remove, objects merge, anything else replaces
+    template<typename PatchType>
+    static void merge(BasicJsonType& target, PatchType& patch)
+    {
+        if (!patch.is_object())
+        {
+            target = forward_value(patch);
+            return;
+        }
+
+        if (!target.is_object())
+        {
+            target = BasicJsonType(value_t::object);
+        }
+
+        for (auto& member : patch.template get_ref<copy_const_t<PatchType, object_t>&>())
+        {
+            if (member.second.is_null())
+            {
+                target.erase(member.first);
+            }
+            else
+            {
+                merge(target[member.first], member.second);
+            }
+        }
+    }
+
+    // a JSON Patch from source to target. equal subtrees are skipped as a
+    // whole, arrays are aligned on the elements that occur once in both
+    static BasicJsonType diff(const BasicJsonType& source, const BasicJsonType& target)
+    {
+        BasicJsonType patch(value_t::array);
+        string_t path;
+        diff(patch, path, source, target);
+        return patch;
+    }
+
+
+private:
+    static void diff(BasicJsonType& patch, string_t& path, const BasicJsonType& source, const BasicJsonType& target)
+    {
+        if (same(source, target))
+        {
+            return;
+        }
+
+        if (source.is_object() && target.is_object())
+        {
+            diff_objects(patch, path, source, target);
+        }
+        else if (source.is_array() && target.is_array())
+        {
+            diff_arrays(patch, path, source, target);
+        }
+        else
+        {
+            push_operation(patch, "replace", path, &target);
+        }
+    }
+
+    static void diff_objects(BasicJsonType& patch, string_t& path, const BasicJsonType& source, const BasicJsonType& target)
+    {
+        const auto& source_object = source.template get_ref<const object_t&>();
+        const auto& target_object = target.template get_ref<const object_t&>();
+        const auto length = path.size();
+        for (const auto& member : source_object)
+        {
+            pointer_t::append_token(path, static_cast<const string_t&>(member.first));
+            const auto iter = target_object.find(member.first);
+            if (iter == target_object.end())
+            {
+                push_operation(patch, "remove", path, nullptr);
+            }
+            else
+            {
+                diff(patch, path, member.second, iter->second);
+            }
+            path.resize(length);
+        }
+
+        for (const auto& member : target_object)
+        {
+            if (source_object.find(member.first) == source_object.end())
+            {
+                pointer_t::append_token(path, static_cast<const string_t&>(member.first));
+                push_operation(patch, "add", path, &member.second);
+                path.resize(length);
+            }
+        }
+    }
+
+    // a common prefix and suffix are skipped, the middle is aligned on the
+    // elements whose hash is unique in both, taking the longest increasing
+    // run of them (patience diff). the elements between two anchors are
+    // diffed in pairs, then removed or added, so nothing is quadratic
+    static void diff_arrays(BasicJsonType& patch, string_t& path, const BasicJsonType& source, const BasicJsonType& target)
+    {
+        const auto& source_array = source.template get_ref<const array_t&>();
+        const auto& target_array = target.template get_ref<const array_t&>();
+
+        size_type begin = 0;
+        while (begin < source_array.size() && begin < target_array.size() &&
+            same(source_array[begin], target_array[begin]))
+        {
+            ++begin;
+        }
+
+        size_type source_end = source_array.size();
+        size_type target_end = target_array.size();
+        while (source_end > begin && target_end > begin &&
+            same(source_array[source_end - 1], target_array[target_end - 1]))
+        {
+            --source_end;
+            --target_end;
+        }
+
+        // hash -> index in the middle of source, npos if it is not unique
+        std::unordered_map<std::size_t, size_type> source_hashes;
+        for (size_type i = begin; i < source_end; ++i)
+        {
+            const auto result = source_hashes.emplace(source_array[i].hash(), i);
+            if (!result.second)
+            {
+                result.first->second = npos;
+            }
+        }
+
+        std::unordered_map<std::size_t, std::pair<size_type, size_type>> matches;
+        for (size_type i = begin; i < target_end; ++i)
+        {
+            const auto hash = target_array[i].hash();
+            const auto iter = source_hashes.find(hash);
+            if (iter != source_hashes.end() && iter->second != npos)
+            {
+                const auto result = matches.emplace(hash, std::make_pair(iter->second, i));
+                if (!result.second)
+                {
+                    result.first->second.first = npos;
+                }
+            }
+        }
+
+        // anchors ordered by their source index
+        std::vector<std::pair<size_type, size_type>> anchors;
+        for (size_type i = begin; i < source_end; ++i)
+        {
+            const auto iter = matches.find(source_array[i].hash());
+            if (iter != matches.end() && iter->second.first == i &&
+                source_array[i] == target_array[iter->second.second])
+            {
+                anchors.push_back(iter->second);
+            }
+        }
+        anchors = longest_increasing(anchors);
+        anchors.emplace_back(source_end, target_end);
+
+        // index is where the next source element is in the patched array
+        const auto length = path.size();
+        size_type index = begin;
+        size_type source_pos = begin;
+        size_type target_pos = begin;
+        for (const auto& anchor : anchors)
+        {
+            const size_type common = std::min(anchor.first - source_pos, anchor.second - target_pos);
+            for (size_type i = 0; i < common; ++i, ++index)
+            {
+                append_index(path, index);
+                diff(patch, path, source_array[source_pos + i], target_array[target_pos + i]);
+                path.resize(length);
+            }
+
+            for (size_type i = source_pos + common; i < anchor.first; ++i)
+            {
+                append_index(path, index);
+                push_operation(patch, "remove", path, nullptr);
+                path.resize(length);
+            }
+
+            for (size_type i = target_pos + common; i < anchor.second; ++i, ++index)
+            {
+                append_index(path, index);
+                push_operation(patch, "add", path, &target_array[i]);
+                path.resize(length);
+            }
+
+            // the anchor itself is equal
+            source_pos = anchor.first + 1;
+            target_pos = anchor.second + 1;
+            ++index;
+        }
+    }
+
+    // the longest subsequence of pairs whose second members increase
+    static std::vector<std::pair<size_type, size_type>> longest_increasing(const std::vector<std::pair<size_type, size_type>>& pairs)
+    {
+        std::vector<size_type> tails;       // tails[k], the pair ending the best run of length k + 1
+        std::vector<size_type> previous(pairs.size(), npos);
+        for (size_type i = 0; i < pairs.size(); ++i)
+        {
+            const auto iter = std::lower_bound(tails.begin(), tails.end(), pairs[i].second,
+                [&pairs](const size_type tail, const size_type value) { return pairs[tail].second < value; });
+            previous[i] = iter == tails.begin() ? npos : *(iter - 1);
+            if (iter == tails.end())
+            {
+                tails.push_back(i);
+            }
+            else
+            {
+                *iter = i;
+            }
+        }
+
+        std::vector<std::pair<size_type, size_type>> result(tails.size());
+        for (size_type i = tails.empty() ? npos : tails.back(), k = tails.size(); i != npos; i = previous[i])
+        {
+            result[--k] = pairs[i];
+        }
+        return result;
+    }
+
+    static bool same(const BasicJsonType& lhs, const BasicJsonType& rhs)
+    {
+#if defined(SJSON_HASH_CACHE)
+        // cached hashes tell a changed subtree in O(1)
+        if (lhs.hash() != rhs.hash())
+        {
+            return false;
+        }
+#endif
+        return lhs == rhs;
+    }
+
+    static void append_index(string_t& path, size_type index)
+    {
+        char_type digits[24];
+        size_type size = 0;
+        do
+        {
+            digits[size++] = static_cast<char_type>('0' + index % 10);
+            index /= 10;
+        } while (index);
+
+        path.push_back(char_type('/'));
+        while (size)
+        {
+            path.push_back(digits[--size]);
+        }
+    }
+
+    static void push_operation(BasicJsonType& patch, const char* op, const string_t& path, const BasicJsonType* value)
+    {
+        BasicJsonType operation(value_t::object);
+        operation["op"] = op;
+        operation["path"] = path;
+        if (value != nullptr)
+        {
+            operation["value"] = *value;
+        }
+        patch.push_back(std::move(operation));
+    }
+
+    template<typename From, typename Ty>
+    using copy_const_t = typename std::conditional<std::is_const<From>::value, const Ty, Ty>::type;
+
+    // a value of a const patch is copied, of a mutable one moved
+    static const BasicJsonType& forward_value(const BasicJsonType& value)   { return value;             }
+    static BasicJsonType&& forward_value(BasicJsonType& value)              { return std::move(value);  }
+
+    // undoing assign or erase takes out the value at path, which the
+    // insert_taken of a move puts back where it was taken from
+    enum class undo_t : std::uint8_t
+    {
+        assign,         // put value back at path
+        erase,          // remove what was added at path
+        insert,         // put value back where it was removed from path
+        insert_taken    // put the value of the last undo back at path
+    };
+
+    struct undo_entry
+    {
+        undo_t              kind;
+        const pointer_t*    path;
+        size_type           index;      // the array index of path
+        BasicJsonType       value;
+    };
+
+    // an operation records at most two entries, so recording never allocates
+    json_patch(BasicJsonType& document, const bool atomic, const size_type operations)
+        : m_document(document), m_atomic(atomic)
+    {
+        if (atomic)
+        {
+            m_undo.reserve(2 * operations);
+        }
+    }
+
+    template<typename OperationType>
+    void apply_operation(OperationType& operation, const pointer_t& path, const pointer_t& from)
+    {
+        const auto& op = operation.at("op").as_string();
+        if (op == "add")
+        {
+            add(path, BasicJsonType(forward_value(value_of(operation))));
+        }
+        else if (op == "remove")
+        {
+            size_type index = 0;
+            auto value = take(path, index);
+            record(undo_t::insert, path, index, std::move(value));
+        }
+        else if (op == "replace")
+        {
+            auto& target = locate(path);
+            record(undo_t::assign, path, 0, std::move(target));
+            target = forward_value(value_of(operation));
+        }
+        else if (op == "move")
+        {
+            if (!operation.contains("from"))
+            {
+                throw json_patch_error("json patch move needs a \"from\"");
+            }
+
+            if (is_proper_prefix(from, path))
+            {
+                throw json_patch_error("json patch cannot move a value into itself");
+            }
+
+            if (from != path)
+            {
+                size_type index = 0;
+                auto value = take(from, index);
+                record(undo_t::insert_taken, from, index, BasicJsonType());
+                try
+                {
+                    add(path, std::move(value));
+                }
+                catch (...)
+                {
+                    // add throws before it moves the value or records anything,
+                    // so the undo puts the value itself back at from
+                    if (m_atomic)
+                    {
+                        m_undo.back() = undo_entry{ undo_t::insert, &from, index, std::move(value) };
+                    }
+                    throw;
+                }
+            }
+        }
+        else if (op == "copy")
+        {
+            if (!operation.contains("from"))
+            {
+                throw json_patch_error("json patch copy needs a \"from\"");
+            }
+
+            add(path, BasicJsonType(read(from)));
+        }
+        else if (op == "test")
+        {
+            if (read(path) != value_of(operation))
+            {
+                throw json_patch_error("json patch test failed");
+            }
+        }
+        else
+        {
+            throw json_patch_error("json patch has an unknown operation");
+        }
+    }
+
+    template<typename OperationType>
+    static auto value_of(OperationType& operation) -> decltype(operation.at("value"))
+    {
+        if (!operation.contains("value"))
+        {
+            throw json_patch_error("json patch operation needs a \"value\"");
+        }
+
+        return operation.at("value");
+    }
+
+    void add(const pointer_t& path, BasicJsonType&& value)
+    {
+        if (path.empty())
+        {
+            record(undo_t::assign, path, 0, std::move(m_document));
+            m_document = std::move(value);
+            return;
+        }
+
+        auto& parent = locate(path, path.size() - 1);
+        const auto& token = path[path.size() - 1];
+        if (parent.is_object())
+        {
+            auto& object = parent.template get_ref<object_t&>();
+            auto iter = object.find(token.key);
+            if (iter != object.end())
+            {
+                record(undo_t::assign, path, 0, std::move(iter->second));
+                iter->second = std::move(value);
+            }
+            else
+            {
+                object.emplace(token.key, std::move(value));
+                record(undo_t::erase, path, 0, BasicJsonType());
+            }
+        }
+        else if (parent.is_array())
+        {
+            auto& array = parent.template get_ref<array_t&>();
+            const bool append = static_cast<const string_t&>(token.key) == "-";
+            const size_type index = append ? array.size() : token.index;
+            if (index > array.size())
+            {
+                throw json_patch_error("json patch array index out of range");
+            }
+
+            array.insert(array.begin() + index, std::move(value));
+            record(undo_t::erase, path, index, BasicJsonType());
+        }
+        else
+        {
+            throw json_patch_error("json patch path parent is not a container");
+        }
+    }
+
+    // remove the value at path and return it, index is its array index
+    BasicJsonType take(const pointer_t& path, size_type& index)
+    {
+        if (path.empty())
+        {
+            throw json_patch_error("json patch cannot remove the whole document");
+        }
+
+        auto& parent = locate(path, path.size() - 1);
+        const auto& token = path[path.size() - 1];
+        BasicJsonType value;
+        if (parent.is_object())
+        {
+            auto& object = parent.template get_ref<object_t&>();
+            auto iter = object.find(token.key);
+            if (iter == object.end())
+            {
+                throw json_patch_error("json patch path not found");
+            }
+
+            value = std::move(iter->second);
+            object.erase(iter);
+        }
+        else if (parent.is_array())
+        {
+            auto& array = parent.template get_ref<array_t&>();
+            index = token.index;
+            if (index >= array.size())
+            {
+                throw json_patch_error("json patch array index out of range");
+            }
+
+            value = std::move(array[index]);
+            array.erase(array.begin() + index);
+        }
+        else
+        {
+            throw json_patch_error("json patch path parent is not a container");
+        }
+
+        return value;
+    }
+
+    // the value at the first count tokens of path. JsonType is BasicJsonType
+    // or const BasicJsonType, the const one neither detaches a shared
+    // container nor unpacks a packed array
+    template<typename JsonType>
+    static JsonType& locate(JsonType& document, const pointer_t& path, size_type count)
+    {
+        JsonType* json = &document;
+        for (size_type i = 0; i < count; ++i)
+        {
+            const auto& token = path[i];
+            if (json->is_object())
+            {
+                auto& object = json->template get_ref<copy_const_t<JsonType, object_t>&>();
+                auto iter = object.find(token.key);
+                if (iter == object.end())
+                {
+                    throw json_patch_error("json patch path not found");
+                }
+                json = &iter->second;
+            }
+            else if (json->is_array())
+            {
+                if (token.index >= json->size())
+                {
+                    throw json_patch_error("json patch array index out of range");
+                }
+                json = &element(*json, token.index);
+            }
+            else
+            {
+                throw json_patch_error("json patch path not found");
+            }
+        }
+        return *json;
+    }
+
+    static BasicJsonType& element(BasicJsonType& array, const size_type index)
+    {
+        return array.template get_ref<array_t&>()[index];
+    }
+
+    static const BasicJsonType& element(const BasicJsonType& array, const size_type index)
+    {
+        return array[index];
+    }
+
+    BasicJsonType& locate(const pointer_t& path, size_type count)
+    {
+        return locate(m_document, path, count);
+    }
+
+    BasicJsonType& locate(const pointer_t& path)
+    {
+        return locate(m_document, path, path.size());
+    }
+
+    // test and copy only read
+    const BasicJsonType& read(const pointer_t& path)const
+    {
+        return locate(static_cast<const BasicJsonType&>(m_document), path, path.size());
+    }
+
+    static bool is_proper_prefix(const pointer_t& prefix, const pointer_t& path)
+    {
+        if (prefix.size() >= path.size())
+        {
+            return false;
+        }
+
+        for (size_type i = 0; i < prefix.size(); ++i)
+        {
+            if (!(prefix[i].key == path[i].key))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void record(const undo_t kind, const pointer_t& path, const size_type index, BasicJsonType&& value)
+    {
+        if (m_atomic)
+        {
+            m_undo.push_back(undo_entry{ kind, &path, index, std::move(value) });
+        }
+    }
+
+    // undo in reverse order, every path is valid again when its entry is undone
+    void rollback()
+    {
+        BasicJsonType taken;
+        while (!m_undo.empty())
+        {
+            auto& entry = m_undo.back();
+            const auto& path = *entry.path;
+            if (entry.kind == undo_t::assign)
+            {
+                auto& target = locate(path);
+                taken = std::move(target);
+                target = std::move(entry.value);
+                m_undo.pop_back();
+                continue;
+            }
+
+            auto& parent = locate(path, path.size() - 1);
+            const auto& key = path[path.size() - 1].key;
+            auto& value = entry.kind == undo_t::insert_taken ? taken : entry.value;
+            if (parent.is_object())
+            {
+                auto& object = parent.template get_ref<object_t&>();
+                if (entry.kind == undo_t::erase)
+                {
+                    const auto iter = object.find(key);
+                    taken = std::move(iter->second);
+                    object.erase(iter);
+                }
+                else
+                {
+                    object.emplace(key, std::move(value));
+                }
+            }
+            else
+            {
+                auto& array = parent.template get_ref<array_t&>();
+                if (entry.kind == undo_t::erase)
+                {
+                    taken = std::move(array[entry.index]);
+                    array.erase(array.begin() + entry.index);
+                }
+                else
+                {
+                    array.insert(array.begin() + entry.index, std::move(value));
+                }
+            }
+            m_undo.pop_back();
+        }
+    }
+
+private:
+    BasicJsonType&              m_document;
+    bool                        m_atomic;
+    std::vector<undo_entry>     m_undo;
+};
+
+
+template<typename BasicJsonType>
+constexpr typename json_patch<BasicJsonType>::size_type json_patch<BasicJsonType>::npos;
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_PATCH_HPP
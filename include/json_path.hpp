@@ -0,0 +1,1015 @@
+#ifndef JSON_PATH_HPP
+#define JSON_PATH_HPP
+
+#include <cstddef>      // size_t
+#include <cstdint>      // uint8_t
+#include <string>       // string
+#include <vector>       // vector
+#include <type_traits>  // conditional, is_const
+#include "json_tape.hpp"
+#include "json_string_view.hpp"
+#include "json_exception.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_path, a JSONPath query compiled once into a plan of segments, such as
+//   $.store.book[?(@.price < 10)].title
+//   $..author   $.items[*]   $.items[-1]   $.items[0,2]   $.items[1:10:2]   $['a b']
+//
+// a filter compares @-relative paths and literals (numbers, strings, true,
+// false, null) with == != < <= > >=, combined with && || ! and parentheses,
+// a path alone tests that it exists. values of different types are unequal
+// and unordered, and objects and arrays are never equal to anything.
+//
+// select() runs the plan over a basic_json and returns pointers to the
+// matching nodes, or over a json_tape_view and returns views, nothing is
+// copied. only the members the plan reaches are visited, on a tape the
+// other subtrees are skipped without being read
+//
+template<typename BasicJsonType>
+class json_path
+{
+public:
+    using string_t      = typename BasicJsonType::string_t;
+    using key_t         = typename BasicJsonType::key_t;
+    using object_t      = typename BasicJsonType::object_t;
+    using array_t       = typename BasicJsonType::array_t;
+    using char_type     = typename BasicJsonType::char_type;
+    using float_t       = typename BasicJsonType::number_float_t;
+    using string_view_t = basic_string_view<char_type>;
+    using tape_view_t   = json_tape_view<BasicJsonType>;
+    using size_type     = std::size_t;
+
+public:
+    explicit json_path(const string_t& query)
+    {
+        compile(query);
+    }
+
+    explicit json_path(const char_type* query)
+    {
+        compile(string_t(query));
+    }
+
+    std::vector<const BasicJsonType*> select(const BasicJsonType& json)const
+    {
+        return run<dom_access<const BasicJsonType>>(&json);
+    }
+
+    // mutable pointers, a shared container is detached like by operator[]
+    std::vector<BasicJsonType*> select(BasicJsonType& json)const
+    {
+        return run<dom_access<BasicJsonType>>(&json);
+    }
+
+    std::vector<tape_view_t> select(const tape_view_t& view)const
+    {
+        return run<tape_access>(view);
+    }
+
+
+private:
+    enum class selector_t : std::uint8_t
+    {
+        name,
+        wildcard,
+        index,
+        slice,
+        filter
+    };
+
+    struct selector
+    {
+        selector_t  kind;
+        key_t       key;            // name
+        string_t    name;
+        long long   start;          // index, slice
+        long long   end;
+        long long   step;
+        bool        has_start;
+        bool        has_end;
+        size_type   filter;         // the root expression of a filter
+    };
+
+    struct segment
+    {
+        bool                    descendant;     // ..
+        std::vector<selector>   selectors;
+    };
+
+    enum class expression_t : std::uint8_t
+    {
+        logical_or,
+        logical_and,
+        logical_not,
+        exists,
+        compare
+    };
+
+    enum class compare_t : std::uint8_t
+    {
+        equal,
+        not_equal,
+        less,
+        less_equal,
+        greater,
+        greater_equal
+    };
+
+    enum class scalar_t : std::uint8_t
+    {
+        missing,
+        null,
+        boolean,
+        number,
+        string,
+        structured
+    };
+
+    // an operand of a comparison, a literal or a path from @ of names and indices
+    struct operand
+    {
+        bool                    is_path;
+        std::vector<selector>   path;
+        scalar_t                kind;
+        bool                    boolean;
+        float_t                 number;
+        string_t                text;
+    };
+
+    struct expression
+    {
+        expression_t    kind;
+        compare_t       op;
+        size_type       left;       // sub expressions or operands
+        size_type       right;
+    };
+
+    struct scalar
+    {
+        scalar_t        kind;
+        bool            boolean;
+        float_t         number;
+        string_view_t   text;
+    };
+
+
+private:
+    //
+    // node access, a pointer to a basic_json or a tape view
+    //
+    template<typename JsonType>
+    struct dom_access
+    {
+        using node_type = JsonType*;
+        using object_ref = typename std::conditional<std::is_const<JsonType>::value, const object_t&, object_t&>::type;
+
+        static const BasicJsonType& value(const node_type node) { return *node; }
+
+        // a const packed array is read from its views, it is not unpacked
+        static node_type element(const node_type node, const size_type index)
+        {
+            return &array_element(*node, index);
+        }
+
+        static BasicJsonType& array_element(BasicJsonType& json, const size_type index)
+        {
+            return json.template get_ref<array_t&>()[index];
+        }
+
+        static const BasicJsonType& array_element(const BasicJsonType& json, const size_type index)
+        {
+            return json[index];
+        }
+
+        static bool find(const node_type node, const selector& sel, node_type& child)
+        {
+            auto& object = node->template get_ref<object_ref>();
+            const auto iter = object.find(sel.key);
+            if (iter == object.end())
+            {
+                return false;
+            }
+            child = &iter->second;
+            return true;
+        }
+
+        template<typename Executor>
+        static void each_child(const node_type node, Executor& executor, const typename Executor::action act, const size_type index, const selector* sel)
+        {
+            if (node->is_object())
+            {
+                for (auto& member : node->template get_ref<object_ref>())
+                {
+                    executor.child(&member.second, act, index, sel);
+                }
+            }
+            else if (node->is_array())
+            {
+                for (size_type i = 0, size = node->size(); i < size; ++i)
+                {
+                    executor.child(element(node, i), act, index, sel);
+                }
+            }
+        }
+    };
+
+    struct tape_access
+    {
+        using node_type = tape_view_t;
+
+        static const tape_view_t& value(const node_type& node) { return node; }
+
+        static node_type element(const node_type& node, const size_type index)
+        {
+            return node[index];
+        }
+
+        static bool find(const node_type& node, const selector& sel, node_type& child)
+        {
+            const auto iter = node.find(string_view_t(sel.name));
+            if (iter == node.end())
+            {
+                return false;
+            }
+            child = *iter;
+            return true;
+        }
+
+        template<typename Executor>
+        static void each_child(const node_type& node, Executor& executor, const typename Executor::action act, const size_type index, const selector* sel)
+        {
+            if (node.is_object() || node.is_array())
+            {
+                for (const auto child : node)
+                {
+                    executor.child(child, act, index, sel);
+                }
+            }
+        }
+    };
+
+
+    //
+    // executor, runs the plan from one node and collects the matches
+    //
+    template<typename Access>
+    class executor
+    {
+    public:
+        using access_type   = Access;
+        using node_type     = typename Access::node_type;
+
+        enum class action : std::uint8_t
+        {
+            next,           // the child matched the selector, run the next segment
+            filter,         // the child matches if it passes the filter
+            descend         // apply the segment to the child and all its descendants
+        };
+
+    public:
+        executor(const json_path& path, std::vector<node_type>& result) : m_path(path), m_result(result) { }
+
+        void run(const node_type& node, const size_type index)
+        {
+            if (index == m_path.m_segments.size())
+            {
+                m_result.push_back(node);
+                return;
+            }
+
+            if (m_path.m_segments[index].descendant)
+            {
+                descend(node, index);
+            }
+            else
+            {
+                select(node, index);
+            }
+        }
+
+        void child(const node_type& node, const action act, const size_type index, const selector* sel)
+        {
+            switch (act)
+            {
+                case action::next:
+                    run(node, index + 1);
+                    break;
+
+                case action::filter:
+                    if (m_path.test(sel->filter, Access::value(node), node, *this))
+                    {
+                        run(node, index + 1);
+                    }
+                    break;
+
+                case action::descend:
+                    descend(node, index);
+                    break;
+            }
+        }
+
+        // a path of names and indices from node, false if it leads nowhere
+        bool follow(const std::vector<selector>& path, node_type& node)const
+        {
+            for (const auto& sel : path)
+            {
+                const auto& value = Access::value(node);
+                if (sel.kind == selector_t::name)
+                {
+                    if (!value.is_object() || !Access::find(node, sel, node))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    size_type position = 0;
+                    if (!value.is_array() || !normalize(sel.start, value.size(), position))
+                    {
+                        return false;
+                    }
+                    node = Access::element(node, position);
+                }
+            }
+            return true;
+        }
+
+    private:
+        void descend(const node_type& node, const size_type index)
+        {
+            select(node, index);
+            Access::each_child(node, *this, action::descend, index, nullptr);
+        }
+
+        void select(const node_type& node, const size_type index)
+        {
+            const auto& value = Access::value(node);
+            for (const auto& sel : m_path.m_segments[index].selectors)
+            {
+                switch (sel.kind)
+                {
+                    case selector_t::name:
+                    {
+                        node_type child = node;
+                        if (value.is_object() && Access::find(node, sel, child))
+                        {
+                            run(child, index + 1);
+                        }
+                        break;
+                    }
+
+                    case selector_t::wildcard:
+                        Access::each_child(node, *this, action::next, index, &sel);
+                        break;
+
+                    case selector_t::filter:
+                        Access::each_child(node, *this, action::filter, index, &sel);
+                        break;
+
+                    case selector_t::index:
+                    {
+                        size_type position = 0;
+                        if (value.is_array() && normalize(sel.start, value.size(), position))
+                        {
+                            run(Access::element(node, position), index + 1);
+                        }
+                        break;
+                    }
+
+                    case selector_t::slice:
+                        if (value.is_array())
+                        {
+                            slice(node, sel, static_cast<long long>(value.size()), index);
+                        }
+                        break;
+                }
+            }
+        }
+
+        void slice(const node_type& node, const selector& sel, const long long size, const size_type index)
+        {
+            if (sel.step == 0)
+            {
+                return;
+            }
+
+            const auto clamp = [](const long long val, const long long low, const long long high)
+            {
+                return val < low ? low : (val > high ? high : val);
+            };
+            const auto bound = [size](const long long val) { return val >= 0 ? val : size + val; };
+
+            if (sel.step > 0)
+            {
+                const long long lower = clamp(sel.has_start ? bound(sel.start) : 0, 0, size);
+                const long long upper = clamp(sel.has_end ? bound(sel.end) : size, 0, size);
+                for (long long i = lower; i < upper; i += sel.step)
+                {
+                    run(Access::element(node, static_cast<size_type>(i)), index + 1);
+                }
+            }
+            else
+            {
+                const long long upper = clamp(sel.has_start ? bound(sel.start) : size - 1, -1, size - 1);
+                const long long lower = clamp(sel.has_end ? bound(sel.end) : -size - 1, -1, size - 1);
+                for (long long i = upper; lower < i; i += sel.step)
+                {
+                    run(Access::element(node, static_cast<size_type>(i)), index + 1);
+                }
+            }
+        }
+
+    private:
+        const json_path&        m_path;
+        std::vector<node_type>& m_result;
+    };
+
+
+private:
+    template<typename Access>
+    std::vector<typename Access::node_type> run(const typename Access::node_type& root)const
+    {
+        std::vector<typename Access::node_type> result;
+        executor<Access> exec(*this, result);
+        exec.run(root, 0);
+        return result;
+    }
+
+    // a negative index counts from the end
+    static bool normalize(const long long index, const size_type size, size_type& position)noexcept
+    {
+        const long long count = static_cast<long long>(size);
+        const long long pos = index >= 0 ? index : count + index;
+        if (pos < 0 || pos >= count)
+        {
+            return false;
+        }
+        position = static_cast<size_type>(pos);
+        return true;
+    }
+
+    template<typename ValueType, typename NodeType, typename Executor>
+    bool test(const size_type index, const ValueType& value, const NodeType& node, const Executor& exec)const
+    {
+        const auto& expr = m_expressions[index];
+        switch (expr.kind)
+        {
+            case expression_t::logical_or:
+                return test(expr.left, value, node, exec) || test(expr.right, value, node, exec);
+
+            case expression_t::logical_and:
+                return test(expr.left, value, node, exec) && test(expr.right, value, node, exec);
+
+            case expression_t::logical_not:
+                return !test(expr.left, value, node, exec);
+
+            case expression_t::exists:
+            {
+                NodeType target = node;
+                return exec.follow(m_operands[expr.left].path, target);
+            }
+
+            default:
+                return compare(evaluate(m_operands[expr.left], node, exec), expr.op, evaluate(m_operands[expr.right], node, exec));
+        }
+    }
+
+    template<typename NodeType, typename Executor>
+    static scalar evaluate(const operand& opd, const NodeType& node, const Executor& exec)
+    {
+        scalar result{ opd.kind, opd.boolean, opd.number, string_view_t() };
+        if (!opd.is_path)
+        {
+            result.text = string_view_t(opd.text);
+            return result;
+        }
+
+        NodeType target = node;
+        if (!exec.follow(opd.path, target))
+        {
+            result.kind = scalar_t::missing;
+            return result;
+        }
+
+        const auto& value = Executor::access_type::value(target);
+        if (value.is_null())
+        {
+            result.kind = scalar_t::null;
+        }
+        else if (value.is_bool())
+        {
+            result.kind = scalar_t::boolean;
+            result.boolean = value.as_bool();
+        }
+        else if (value.is_number())
+        {
+            result.kind = scalar_t::number;
+            result.number = value.as_float();
+        }
+        else if (value.is_string())
+        {
+            result.kind = scalar_t::string;
+            result.text = string_view_t(value.as_string());
+        }
+        else
+        {
+            result.kind = scalar_t::structured;
+        }
+        return result;
+    }
+
+    static bool compare(const scalar& lhs, const compare_t op, const scalar& rhs)
+    {
+        bool equal = false;
+        bool less = false;
+        bool ordered = false;
+        if (lhs.kind == rhs.kind)
+        {
+            switch (lhs.kind)
+            {
+                case scalar_t::missing:
+                case scalar_t::null:
+                    equal = true;
+                    break;
+
+                case scalar_t::boolean:
+                    equal = lhs.boolean == rhs.boolean;
+                    break;
+
+                case scalar_t::number:
+                    equal = lhs.number == rhs.number;
+                    less = lhs.number < rhs.number;
+                    ordered = true;
+                    break;
+
+                case scalar_t::string:
+                    equal = lhs.text == rhs.text;
+                    less = lhs.text < rhs.text;
+                    ordered = true;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        switch (op)
+        {
+            case compare_t::equal:          return equal;
+            case compare_t::not_equal:      return !equal;
+            case compare_t::less:           return ordered && less;
+            case compare_t::less_equal:     return ordered && (less || equal);
+            case compare_t::greater:        return ordered && !less && !equal;
+            default:                        return ordered && !less;
+        }
+    }
+
+
+private:
+    //
+    // the compiler, a recursive descent over the query text
+    //
+    void compile(const string_t& query)
+    {
+        m_text = &query;
+        m_pos = 0;
+
+        skip_spaces();
+        if (!consume('$'))
+        {
+            error("must begin with '$'");
+        }
+
+        while (skip_spaces(), m_pos < query.size())
+        {
+            segment seg{ false, std::vector<selector>() };
+            if (consume('.'))
+            {
+                seg.descendant = consume('.');
+                if (consume('*'))
+                {
+                    seg.selectors.push_back(make_selector(selector_t::wildcard));
+                }
+                else if (peek() == '[' && seg.descendant)
+                {
+                    ++m_pos;
+                    parse_brackets(seg.selectors);
+                }
+                else
+                {
+                    auto sel = make_selector(selector_t::name);
+                    set_name(sel, parse_dot_name());
+                    seg.selectors.push_back(std::move(sel));
+                }
+            }
+            else if (consume('['))
+            {
+                parse_brackets(seg.selectors);
+            }
+            else
+            {
+                error("expects '.' or '['");
+            }
+            m_segments.push_back(std::move(seg));
+        }
+
+        m_text = nullptr;
+    }
+
+    // after '[', up to and including ']'
+    void parse_brackets(std::vector<selector>& selectors)
+    {
+        do
+        {
+            skip_spaces();
+            const char_type ch = peek();
+            if (ch == '\'' || ch == '"')
+            {
+                auto sel = make_selector(selector_t::name);
+                set_name(sel, parse_quoted());
+                selectors.push_back(std::move(sel));
+            }
+            else if (ch == '*')
+            {
+                ++m_pos;
+                selectors.push_back(make_selector(selector_t::wildcard));
+            }
+            else if (ch == '?')
+            {
+                ++m_pos;
+                auto sel = make_selector(selector_t::filter);
+                sel.filter = parse_or();
+                selectors.push_back(std::move(sel));
+            }
+            else
+            {
+                selectors.push_back(parse_index_or_slice());
+            }
+            skip_spaces();
+        } while (consume(','));
+
+        if (!consume(']'))
+        {
+            error("expects ']'");
+        }
+    }
+
+    selector parse_index_or_slice()
+    {
+        auto sel = make_selector(selector_t::index);
+        sel.has_start = parse_integer(sel.start);
+        skip_spaces();
+        if (!consume(':'))
+        {
+            if (!sel.has_start)
+            {
+                error("expects a selector");
+            }
+            return sel;
+        }
+
+        sel.kind = selector_t::slice;
+        skip_spaces();
+        sel.has_end = parse_integer(sel.end);
+        skip_spaces();
+        if (consume(':'))
+        {
+            skip_spaces();
+            if (!parse_integer(sel.step))
+            {
+                sel.step = 1;
+            }
+        }
+        return sel;
+    }
+
+    // or := and ('||' and)*
+    size_type parse_or()
+    {
+        size_type left = parse_and();
+        while (skip_spaces(), consume('|'))
+        {
+            expect('|');
+            const size_type right = parse_and();
+            left = add_expression(expression_t::logical_or, compare_t::equal, left, right);
+        }
+        return left;
+    }
+
+    // and := unary ('&&' unary)*
+    size_type parse_and()
+    {
+        size_type left = parse_unary();
+        while (skip_spaces(), consume('&'))
+        {
+            expect('&');
+            const size_type right = parse_unary();
+            left = add_expression(expression_t::logical_and, compare_t::equal, left, right);
+        }
+        return left;
+    }
+
+    // unary := '!' unary | '(' or ')' | operand (op operand)?
+    size_type parse_unary()
+    {
+        skip_spaces();
+        if (consume('!'))
+        {
+            return add_expression(expression_t::logical_not, compare_t::equal, parse_unary(), 0);
+        }
+
+        if (consume('('))
+        {
+            const size_type inner = parse_or();
+            skip_spaces();
+            expect(')');
+            return inner;
+        }
+
+        const size_type left = parse_operand();
+        skip_spaces();
+        compare_t op = compare_t::equal;
+        if (!parse_compare(op))
+        {
+            if (!m_operands[left].is_path)
+            {
+                error("a filter literal needs a comparison");
+            }
+            return add_expression(expression_t::exists, op, left, 0);
+        }
+
+        const size_type right = parse_operand();
+        return add_expression(expression_t::compare, op, left, right);
+    }
+
+    bool parse_compare(compare_t& op)
+    {
+        const char_type ch = peek();
+        const char_type next = m_pos + 1 < m_text->size() ? (*m_text)[m_pos + 1] : char_type(0);
+        if ((ch == '=' || ch == '!') && next == '=')
+        {
+            op = ch == '=' ? compare_t::equal : compare_t::not_equal;
+            m_pos += 2;
+            return true;
+        }
+
+        if (ch == '<' || ch == '>')
+        {
+            const bool or_equal = next == '=';
+            op = ch == '<' ? (or_equal ? compare_t::less_equal : compare_t::less) : (or_equal ? compare_t::greater_equal : compare_t::greater);
+            m_pos += or_equal ? 2 : 1;
+            return true;
+        }
+        return false;
+    }
+
+    size_type parse_operand()
+    {
+        skip_spaces();
+        operand opd{ false, std::vector<selector>(), scalar_t::null, false, float_t(0), string_t() };
+        const char_type ch = peek();
+        if (ch == '@')
+        {
+            ++m_pos;
+            opd.is_path = true;
+            while (true)
+            {
+                if (consume('.'))
+                {
+                    auto sel = make_selector(selector_t::name);
+                    set_name(sel, parse_dot_name());
+                    opd.path.push_back(std::move(sel));
+                }
+                else if (consume('['))
+                {
+                    skip_spaces();
+                    if (peek() == '\'' || peek() == '"')
+                    {
+                        auto sel = make_selector(selector_t::name);
+                        set_name(sel, parse_quoted());
+                        opd.path.push_back(std::move(sel));
+                    }
+                    else
+                    {
+                        auto sel = make_selector(selector_t::index);
+                        if (!parse_integer(sel.start))
+                        {
+                            error("a filter path takes names and indices only");
+                        }
+                        opd.path.push_back(std::move(sel));
+                    }
+                    skip_spaces();
+                    expect(']');
+                }
+                else
+                {
+                    break;
+                }
+            }
+        }
+        else if (ch == '\'' || ch == '"')
+        {
+            opd.kind = scalar_t::string;
+            opd.text = parse_quoted();
+        }
+        else if (ch == '-' || (ch >= '0' && ch <= '9'))
+        {
+            opd.kind = scalar_t::number;
+            opd.number = parse_number();
+        }
+        else if (consume_word("true") || consume_word("false"))
+        {
+            opd.kind = scalar_t::boolean;
+            opd.boolean = ch == 't';
+        }
+        else if (!consume_word("null"))
+        {
+            error("expects a filter operand");
+        }
+
+        m_operands.push_back(std::move(opd));
+        return m_operands.size() - 1;
+    }
+
+    string_t parse_dot_name()
+    {
+        const size_type begin = m_pos;
+        while (m_pos < m_text->size())
+        {
+            const char_type ch = (*m_text)[m_pos];
+            const bool name_char = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+                (ch >= '0' && ch <= '9') || ch == '_' || ch == '-' || static_cast<unsigned long>(ch) >= 0x80;
+            if (!name_char)
+            {
+                break;
+            }
+            ++m_pos;
+        }
+
+        if (begin == m_pos)
+        {
+            error("expects a member name");
+        }
+        return m_text->substr(begin, m_pos - begin);
+    }
+
+    string_t parse_quoted()
+    {
+        const char_type quote = (*m_text)[m_pos++];
+        string_t result;
+        while (m_pos < m_text->size() && (*m_text)[m_pos] != quote)
+        {
+            char_type ch = (*m_text)[m_pos++];
+            if (ch == '\\' && m_pos < m_text->size())
+            {
+                ch = (*m_text)[m_pos++];
+            }
+            result.push_back(ch);
+        }
+
+        if (m_pos == m_text->size())
+        {
+            error("has an unterminated string");
+        }
+        ++m_pos;
+        return result;
+    }
+
+    bool parse_integer(long long& value)
+    {
+        const size_type begin = m_pos;
+        const bool negative = consume('-');
+        value = 0;
+        bool digits = false;
+        while (m_pos < m_text->size() && (*m_text)[m_pos] >= '0' && (*m_text)[m_pos] <= '9')
+        {
+            value = value * 10 + ((*m_text)[m_pos++] - '0');
+            digits = true;
+        }
+
+        if (!digits)
+        {
+            m_pos = begin;
+            return false;
+        }
+
+        value = negative ? -value : value;
+        return true;
+    }
+
+    // read by the json parser, so a literal equals the same number in a document
+    float_t parse_number()
+    {
+        const size_type begin = m_pos;
+        while (m_pos < m_text->size())
+        {
+            const char_type ch = (*m_text)[m_pos];
+            if (!((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E'))
+            {
+                break;
+            }
+            ++m_pos;
+        }
+
+        try
+        {
+            return BasicJsonType::parse(m_text->substr(begin, m_pos - begin)).as_float();
+        }
+        catch (const json_exception&)
+        {
+            error("has an invalid number");
+        }
+    }
+
+    size_type add_expression(const expression_t kind, const compare_t op, const size_type left, const size_type right)
+    {
+        m_expressions.push_back(expression{ kind, op, left, right });
+        return m_expressions.size() - 1;
+    }
+
+    static selector make_selector(const selector_t kind)
+    {
+        return selector{ kind, key_t(), string_t(), 0, 0, 1, false, false, 0 };
+    }
+
+    static void set_name(selector& sel, string_t name)
+    {
+        sel.key = key_t(name);
+        sel.name = std::move(name);
+    }
+
+    char_type peek()const noexcept
+    {
+        return m_pos < m_text->size() ? (*m_text)[m_pos] : char_type(0);
+    }
+
+    bool consume(const char ch)noexcept
+    {
+        if (peek() != static_cast<char_type>(ch))
+        {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    bool consume_word(const char* word)noexcept
+    {
+        size_type length = 0;
+        while (word[length] != '\0')
+        {
+            if (m_pos + length >= m_text->size() || (*m_text)[m_pos + length] != static_cast<char_type>(word[length]))
+            {
+                return false;
+            }
+            ++length;
+        }
+        m_pos += length;
+        return true;
+    }
+
+    void expect(const char ch)
+    {
+        if (!consume(ch))
+        {
+            error(std::string("expects '") + ch + "'");
+        }
+    }
+
+    void skip_spaces()noexcept
+    {
+        while (m_pos < m_text->size() && ((*m_text)[m_pos] == ' ' || (*m_text)[m_pos] == '\t'))
+        {
+            ++m_pos;
+        }
+    }
+
+    [[noreturn]] void error(const std::string& msg)const
+    {
+        throw json_parse_error("json path " + msg + " at position " + std::to_string(m_pos));
+    }
+
+
+private:
+    std::vector<segment>    m_segments;
+    std::vector<expression> m_expressions;
+    std::vector<operand>    m_operands;
+
+    // the query text, while it is compiled
+    const string_t*         m_text = nullptr;
+    size_type               m_pos = 0;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_PATH_HPP
@@ -0,0 +1,191 @@
+#ifndef JSON_POINTER_HPP
+#define JSON_POINTER_HPP
+
+#include <cstddef>      // size_t
+#include <vector>       // vector
+#include "json_exception.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_pointer, a RFC 6901 JSON Pointer such as "/items/0/name", parsed once.
+// every reference token is kept unescaped as an object key, already interned
+// under SJSON_ATOM_KEYS, and a token made of digits as an array index too,
+// so a lookup through basic_json::at(pointer) builds no string
+//
+template<typename BasicJsonType>
+class json_pointer
+{
+public:
+    using string_t  = typename BasicJsonType::string_t;
+    using key_t     = typename BasicJsonType::key_t;
+    using char_type = typename BasicJsonType::char_type;
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    struct token
+    {
+        key_t       key;
+        size_type   index;      // npos if the token is not an array index
+    };
+
+public:
+    // the empty pointer, the whole document
+    json_pointer() = default;
+
+    explicit json_pointer(const string_t& text)
+    {
+        parse(text);
+    }
+
+    explicit json_pointer(const char_type* text)
+    {
+        parse(string_t(text));
+    }
+
+    size_type size()const noexcept  { return m_tokens.size();   }
+    bool empty()const noexcept      { return m_tokens.empty();  }
+
+    const token& operator[](size_type index)const noexcept { return m_tokens[index]; }
+
+    typename std::vector<token>::const_iterator begin()const noexcept   { return m_tokens.begin();  }
+    typename std::vector<token>::const_iterator end()const noexcept     { return m_tokens.end();    }
+
+    // the pointer text, escaped again
+    string_t to_string()const
+    {
+        string_t result;
+        for (const auto& tok : m_tokens)
+        {
+            append_token(result, static_cast<const string_t&>(tok.key));
+        }
+        return result;
+    }
+
+    // append '/' and the escaped reference token to a pointer text
+    static void append_token(string_t& text, const string_t& reference)
+    {
+        text.push_back(char_type('/'));
+        for (const auto ch : reference)
+        {
+            if (ch == '~')
+            {
+                text.push_back(char_type('~'));
+                text.push_back(char_type('0'));
+            }
+            else if (ch == '/')
+            {
+                text.push_back(char_type('~'));
+                text.push_back(char_type('1'));
+            }
+            else
+            {
+                text.push_back(ch);
+            }
+        }
+    }
+
+    friend bool operator==(const json_pointer& lhs, const json_pointer& rhs)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+
+        for (size_type i = 0; i < lhs.size(); ++i)
+        {
+            if (!(lhs.m_tokens[i].key == rhs.m_tokens[i].key))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend bool operator!=(const json_pointer& lhs, const json_pointer& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+
+private:
+    void parse(const string_t& text)
+    {
+        if (text.empty())
+        {
+            return;
+        }
+
+        if (text[0] != '/')
+        {
+            throw json_parse_error("json pointer must be empty or begin with '/'");
+        }
+
+        string_t reference;
+        for (size_type pos = 1; ; ++pos)
+        {
+            if (pos == text.size() || text[pos] == '/')
+            {
+                m_tokens.push_back(token{ key_t(reference), to_index(reference) });
+                reference.clear();
+                if (pos == text.size())
+                {
+                    break;
+                }
+                continue;
+            }
+
+            if (text[pos] != '~')
+            {
+                reference.push_back(text[pos]);
+                continue;
+            }
+
+            ++pos;
+            if (pos == text.size() || (text[pos] != '0' && text[pos] != '1'))
+            {
+                throw json_parse_error("json pointer has an invalid escape, '~' must be followed by '0' or '1'");
+            }
+            reference.push_back(text[pos] == '0' ? char_type('~') : char_type('/'));
+        }
+    }
+
+    // "0" or digits without a leading zero, "-" and the rest are not indices
+    static size_type to_index(const string_t& reference)noexcept
+    {
+        if (reference.empty() || (reference[0] == '0' && reference.size() > 1))
+        {
+            return npos;
+        }
+
+        size_type index = 0;
+        for (const auto ch : reference)
+        {
+            if (ch < '0' || ch > '9' || index > (npos - 9) / 10)
+            {
+                return npos;
+            }
+            index = index * 10 + static_cast<size_type>(ch - '0');
+        }
+        return index;
+    }
+
+private:
+    std::vector<token>  m_tokens;
+};
+
+template<typename BasicJsonType>
+constexpr typename json_pointer<BasicJsonType>::size_type json_pointer<BasicJsonType>::npos;
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_POINTER_HPP
@@ -0,0 +1,137 @@
+#ifndef JSON_RELEASE_HPP
+#define JSON_RELEASE_HPP
+
+#include <atomic>               // atomic
+#include <utility>              // move
+#include <vector>               // vector
+#include <thread>               // thread
+#include <mutex>                // mutex, lock_guard, unique_lock
+#include <condition_variable>   // condition_variable
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_release_queue, a background thread that destroys the documents handed
+// to it, so the thread that drops a large document does not pay for freeing it.
+// the queue is a function-local static, a document released after it has been
+// destroyed, e.g. by the destructor of another static, is destroyed in place
+//
+
+template<typename BasicJsonType>
+class json_release_queue
+{
+public:
+    static json_release_queue& instance()
+    {
+        static json_release_queue queue;
+        return queue;
+    }
+
+    // hand json to the queue, or destroy it here once the queue is gone
+    static void release(BasicJsonType&& json)
+    {
+        if (shut_down().load(std::memory_order_acquire))
+        {
+            json.clear();
+            return;
+        }
+
+        instance().push(std::move(json));
+    }
+
+    void push(BasicJsonType&& json)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!stopping)
+            {
+                if (!worker.joinable())
+                {
+                    worker = std::thread(&json_release_queue::run, this);
+                }
+                pending.push_back(std::move(json));
+            }
+        }
+
+        // the queue is stopping, json is still here
+        json.clear();
+        ready.notify_one();
+    }
+
+    // block until every document pushed so far has been destroyed
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this]() { return pending.empty() && !busy; });
+    }
+
+    ~json_release_queue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            shut_down().store(true, std::memory_order_release);
+        }
+
+        ready.notify_one();
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+private:
+    json_release_queue() = default;
+
+    // trivially destructible, so it can still be read after the queue is gone
+    static std::atomic<bool>& shut_down()
+    {
+        static std::atomic<bool> flag{ false };
+        return flag;
+    }
+
+    void run()
+    {
+        std::vector<BasicJsonType> batch;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            ready.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty())
+            {
+                break;
+            }
+
+            batch.swap(pending);
+            busy = true;
+
+            lock.unlock();
+            batch.clear();
+            lock.lock();
+
+            busy = false;
+            drained.notify_all();
+        }
+    }
+
+private:
+    std::mutex                  mutex;
+    std::condition_variable     ready;
+    std::condition_variable     drained;
+    std::vector<BasicJsonType>  pending;
+    std::thread                 worker;
+    bool                        busy = false;
+    bool                        stopping = false;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_RELEASE_HPP
@@ -1,14 +1,17 @@
 #ifndef JSON_SERIALIZER_HPP
 #define JSON_SERIALIZER_HPP
 
-#include <cstdio>       // sprintf
+#include <cstddef>      // size_t
+#include <cstring>      // memcpy
 #include <type_traits>  // make_unsigned
 #include <ostream>      // basic_ostream
-#include <sstream>      // ostringstream
-#include <iomanip>      // setprecision
 #include <string>       // basic_string
 #include <array>        // array
+#include <algorithm>    // max
 #include "json_value.hpp"
+#include "json_float.hpp"
+#include "json_integer.hpp"
+#include "json_escape.hpp"
 
 namespace sjson
 {
@@ -79,6 +82,69 @@ private:
 };
 
 
+// writes into a buffer known to be large enough, see basic_json::dump()
+template<typename CharT>
+struct buffer_output_adapter : public output_adapter<CharT>
+{
+    explicit buffer_output_adapter(CharT* buffer)noexcept
+        : cursor(buffer)
+    { }
+
+    virtual void write(const CharT ch)override
+    {
+        *cursor++ = ch;
+    }
+
+    virtual void write(const CharT* s, std::size_t len)override
+    {
+        std::memcpy(cursor, s, len * sizeof(CharT));
+        cursor += len;
+    }
+
+    CharT* end()const noexcept  { return cursor; }
+
+private:
+    CharT* cursor;
+};
+
+
+// writes the first capacity characters into a buffer and counts all of them,
+// see basic_json::dump_to()
+template<typename CharT>
+struct bounded_output_adapter : public output_adapter<CharT>
+{
+    bounded_output_adapter(CharT* buffer, const std::size_t capacity)noexcept
+        : first(buffer), capacity(capacity)
+    { }
+
+    virtual void write(const CharT ch)override
+    {
+        if (count < capacity)
+        {
+            first[count] = ch;
+        }
+        ++count;
+    }
+
+    virtual void write(const CharT* s, std::size_t len)override
+    {
+        if (count < capacity)
+        {
+            const auto room = capacity - count;
+            std::memcpy(first + count, s, (len < room ? len : room) * sizeof(CharT));
+        }
+        count += len;
+    }
+
+    std::size_t size()const noexcept   { return count; }
+
+private:
+    CharT*      first;
+    std::size_t capacity;
+    std::size_t count = 0;
+};
+
+
 
 template<typename BasicJsonType>
 class json_serializer
@@ -89,6 +155,7 @@ public:
     using array_t           = typename BasicJsonType::array_t;
     using string_t          = typename BasicJsonType::string_t;
     using number_integer_t  = typename BasicJsonType::number_integer_t;
+    using number_unsigned_t = typename BasicJsonType::number_unsigned_t;
     using number_float_t    = typename BasicJsonType::number_float_t;
     using boolean_t         = typename BasicJsonType::boolean_t;
 
@@ -112,7 +179,7 @@ public:
 
         case value_t::object:
         {
-            auto& object = *json.m_value.m_data.object;
+            auto& object = json.m_value.object_value();
             if (object.empty())
             {
                 oa.write("{}");
@@ -124,10 +191,7 @@ public:
                 oa.write("{\n");
 
                 const auto new_indent = current_indent + indent_step;
-                if (indent_string.size() < new_indent)
-                {
-                    indent_string.resize(indent_string.size() * 2, indent_char);
-                }
+                grow_indent(new_indent);
 
                 auto iter = object.cbegin();
                 const auto size = object.size();
@@ -176,83 +240,53 @@ public:
 
         case value_t::array:
         {
-            auto& array = *json.m_value.m_data.array;
-            if (array.empty())
+            if (json.m_value.is_packed())
             {
-                oa.write("[]");
-                return;
-            }
-
-            if (indent_step > 0)
-            {
-                oa.write("[\n");
-
-                const auto new_indent = current_indent + indent_step;
-                if (indent_string.size() < new_indent)
-                {
-                    indent_string.resize(indent_string.size() * 2, indent_char);
-                }
-
-                auto iter = array.cbegin();
-                const auto size = array.size();
-                for (std::size_t i = 0; i < size; ++i, ++iter)
-                {
-                    oa.write(indent_string.c_str(), new_indent);
-                    dump(*iter, indent_step, new_indent);
-
-                    // not last element
-                    if (i != size - 1)
-                        oa.write(",\n");
-                }
-
-                oa.write('\n');
-                oa.write(indent_string.c_str(), current_indent);
-                oa.write(']');
+                dump_packed(json.m_value.packed_value(), indent_step, current_indent);
             }
             else
             {
-                oa.write('[');
-                
-                auto iter = array.cbegin();
-                const auto size = array.size();
-                for (std::size_t i = 0; i < size; ++i, ++iter)
-                {
-                    dump(*iter, indent_step, current_indent);
-
-                    // not last element
-                    if (i != size - 1)
-                        oa.write(',');
-                }
-
-                oa.write(']');
+                dump_array(json.m_value.array_value(), indent_step, current_indent);
             }
-            
             return;
         }
 
         case value_t::string:
         {
             oa.write('\"');
-            dump_string(*json.m_value.m_data.string);
+            dump_string(json.m_value.string_value());
             oa.write('\"');
             return;
         }
 
         case value_t::number_integer:
         {
-            dump_integer(json.m_value.m_data.number_integer);
+            dump_integer(json.m_value.integer_value());
+            return;
+        }
+
+        case value_t::number_unsigned:
+        {
+            dump_unsigned(json.m_value.unsigned_value());
+            return;
+        }
+
+        case value_t::number_big_integer:
+        {
+            const auto& text = json.m_value.big_integer_value().str();
+            oa.write(text.c_str(), text.size());
             return;
         }
 
         case value_t::number_float:
         {
-            dump_float(json.m_value.m_data.number_float);
+            dump_float(json.m_value.float_value());
             return;
         }
 
         case value_t::boolean:
         {
-            if (json.m_value.m_data.boolean)
+            if (json.m_value.boolean_value())
             {
                 oa.write("true");
             }
@@ -267,106 +301,315 @@ public:
     }
 
 
-    void dump_integer(number_integer_t num)
+    template<typename ArrayType>
+    void dump_array(const ArrayType& array,
+                    const unsigned int indent_step,
+                    const unsigned int current_indent)
     {
-        if (num == 0)
+        if (array.empty())
         {
-            oa.write('0');
+            oa.write("[]");
             return;
         }
 
-        auto uval = static_cast<typename std::make_unsigned<number_integer_t>::type>(0);
-        if (num < 0)
+        if (indent_step > 0)
         {
-            uval = static_cast<decltype(uval)>(0) - num;
+            oa.write("[\n");
+
+            const auto new_indent = current_indent + indent_step;
+            grow_indent(new_indent);
+
+            auto iter = array.cbegin();
+            const auto size = array.size();
+            for (std::size_t i = 0; i < size; ++i, ++iter)
+            {
+                oa.write(indent_string.c_str(), new_indent);
+                dump_element(*iter, indent_step, new_indent);
+
+                // not last element
+                if (i != size - 1)
+                    oa.write(",\n");
+            }
+
+            oa.write('\n');
+            oa.write(indent_string.c_str(), current_indent);
+            oa.write(']');
         }
         else
         {
-            uval = num;
+            oa.write('[');
+
+            auto iter = array.cbegin();
+            const auto size = array.size();
+            for (std::size_t i = 0; i < size; ++i, ++iter)
+            {
+                dump_element(*iter, indent_step, current_indent);
+
+                // not last element
+                if (i != size - 1)
+                    oa.write(',');
+            }
+
+            oa.write(']');
         }
+    }
 
-        auto iter = number_buffer.rbegin();
-        *iter = '\0';
+    template<typename PackedArrayType>
+    void dump_packed(const PackedArrayType& packed,
+                     const unsigned int indent_step,
+                     const unsigned int current_indent)
+    {
+        switch (packed.element_type())
+        {
+        case value_t::number_integer:
+            dump_array(packed.template elements<number_integer_t>(), indent_step, current_indent);
+            return;
 
-        while (uval)
+        case value_t::number_float:
+            dump_array(packed.template elements<number_float_t>(), indent_step, current_indent);
+            return;
+
+        default:
+            dump_array(packed.template elements<boolean_t>(), indent_step, current_indent);
+            return;
+        }
+    }
+
+    void dump_element(const BasicJsonType& json, const unsigned int indent_step, const unsigned int current_indent)
+    {
+        dump(json, indent_step, current_indent);
+    }
+
+    void dump_element(const number_integer_t num, const unsigned int, const unsigned int)  { dump_integer(num); }
+    void dump_element(const number_float_t num, const unsigned int, const unsigned int)    { dump_float(num);   }
+    void dump_element(const boolean_t val, const unsigned int, const unsigned int)         { oa.write(val ? "true" : "false"); }
+
+    // two digits per step, see format_integer
+    void dump_integer(const number_integer_t num)
+    {
+        const auto last = format_integer(number_buffer.data(), num);
+        oa.write(number_buffer.data(), static_cast<std::size_t>(last - number_buffer.data()));
+    }
+
+    void dump_unsigned(const number_unsigned_t uval)
+    {
+        const auto last = format_unsigned(number_buffer.data(), uval);
+        oa.write(number_buffer.data(), static_cast<std::size_t>(last - number_buffer.data()));
+    }
+
+    // the shortest text that parses back to num, see format_float
+    void dump_float(number_float_t num)
+    {
+        const auto last = format_float(float_buffer.data(), num);
+        oa.write(float_buffer.data(), static_cast<std::size_t>(last - float_buffer.data()));
+    }
+
+    // the exact number of characters dump() writes for json. numbers are
+    // counted without being formatted, apart from floats, and strings by
+    // scanning them for escapes
+    std::size_t size(const BasicJsonType& json,
+                     const unsigned int indent_step,
+                     const unsigned int current_indent = 0)
+    {
+        switch (json.type())
         {
-            *(++iter) = static_cast<char_type>('0' + uval % 10);
-            uval /= 10;
+        case value_t::null:
+            return 4;
+
+        case value_t::object:
+        {
+            const auto& object = json.m_value.object_value();
+            if (object.empty())
+            {
+                return 2;
+            }
+
+            const auto count = object.size();
+            // "key": value and the separators
+            std::size_t result = 2 + 3 * count + (count - 1);
+            const auto new_indent = indent_step > 0 ? current_indent + indent_step : current_indent;
+            if (indent_step > 0)
+            {
+                // the line breaks, indents and spaces after the colons
+                result += 2 + current_indent + (new_indent + 1) * count + (count - 1);
+            }
+
+            for (auto iter = object.cbegin(); iter != object.cend(); ++iter)
+            {
+                result += string_size(iter->first) + size(iter->second, indent_step, new_indent);
+            }
+            return result;
         }
-        
-        if (num < 0)
+
+        case value_t::array:
         {
-            *(++iter) = '-';
+            if (json.m_value.is_packed())
+            {
+                return packed_size(json.m_value.packed_value(), indent_step, current_indent);
+            }
+            return array_size(json.m_value.array_value(), indent_step, current_indent);
         }
 
-        oa.write(&(*iter), static_cast<std::size_t>(iter - number_buffer.rbegin()));
+        case value_t::string:
+            return 2 + string_size(json.m_value.string_value());
+
+        case value_t::number_integer:
+            return integer_size(json.m_value.integer_value());
+
+        case value_t::number_unsigned:
+            return decimal_digits(json.m_value.unsigned_value());
+
+        case value_t::number_big_integer:
+            return json.m_value.big_integer_value().str().size();
+
+        case value_t::number_float:
+            return element_size(json.m_value.float_value(), indent_step, current_indent);
+
+        case value_t::boolean:
+            return json.m_value.boolean_value() ? 4 : 5;
+        }
+        return 0;
     }
 
-    void dump_float(number_float_t num)
+    template<typename ArrayType>
+    std::size_t array_size(const ArrayType& array,
+                           const unsigned int indent_step,
+                           const unsigned int current_indent)
+    {
+        if (array.empty())
+        {
+            return 2;
+        }
+
+        const auto count = array.size();
+        std::size_t result = 2 + (count - 1);
+        const auto new_indent = indent_step > 0 ? current_indent + indent_step : current_indent;
+        if (indent_step > 0)
+        {
+            result += 2 + current_indent + new_indent * count + (count - 1);
+        }
+
+        for (auto iter = array.cbegin(); iter != array.cend(); ++iter)
+        {
+            result += element_size(*iter, indent_step, new_indent);
+        }
+        return result;
+    }
+
+    template<typename PackedArrayType>
+    std::size_t packed_size(const PackedArrayType& packed,
+                            const unsigned int indent_step,
+                            const unsigned int current_indent)
+    {
+        switch (packed.element_type())
+        {
+        case value_t::number_integer:
+            return array_size(packed.template elements<number_integer_t>(), indent_step, current_indent);
+
+        case value_t::number_float:
+            return array_size(packed.template elements<number_float_t>(), indent_step, current_indent);
+
+        default:
+            return array_size(packed.template elements<boolean_t>(), indent_step, current_indent);
+        }
+    }
+
+    std::size_t element_size(const BasicJsonType& json, const unsigned int indent_step, const unsigned int current_indent)
+    {
+        return size(json, indent_step, current_indent);
+    }
+
+    std::size_t element_size(const number_integer_t num, const unsigned int, const unsigned int)   { return integer_size(num); }
+    std::size_t element_size(const boolean_t val, const unsigned int, const unsigned int)          { return val ? 4 : 5;       }
+
+    std::size_t element_size(const number_float_t num, const unsigned int, const unsigned int)
+    {
+        return static_cast<std::size_t>(format_float(float_buffer.data(), num) - float_buffer.data());
+    }
+
+    // the characters of str once escaped, without the quotes
+    static std::size_t string_size(const string_t& str)noexcept
     {
-        std::ostringstream oss;
-        oss << std::setprecision(sizeof(number_float_t) == 8 ? 15 : 7) << num;
-        auto&& str = oss.str();
-        oa.write(str.c_str(), str.size());
+        const char* first = str.data();
+        const char* const last = first + str.size();
+        std::size_t result = str.size();
+        while ((first = find_escape(first, last)) != last)
+        {
+            result += escape_size(*first) - 1;
+            ++first;
+        }
+        return result;
     }
 
+    // runs without escapes go to the output as they are, see find_escape. short
+    // runs and escapes are gathered in string_buffer
     void dump_string(const string_t& str)
     {
+        const char* first = str.data();
+        const char* const last = first + str.size();
         std::size_t index = 0;
-        for (const auto& ch : str)
+        while (true)
         {
-            switch (ch)
+            const char* const next = find_escape(first, last);
+            const auto length = static_cast<std::size_t>(next - first);
+            if (length > 0)
             {
-                case '\b':
-                case '\f':
-                case '\n':
-                case '\r':
-                case '\t':
-                case '\\':
-                case '\"':
+                if (length <= short_run && string_buffer.size() - index >= length)
                 {
-                    string_buffer[index++] = '\\';
-                    string_buffer[index++] = ch;
-                    break;
+                    std::memcpy(string_buffer.data() + index, first, length);
+                    index += length;
                 }
-
-                default:
+                else
                 {
-                    const auto code = static_cast<uint32_t>(ch);
-                    if (code < 0x1f)
+                    if (index > 0)
                     {
-                        // escape control characters (0x00..0x1F)
-                        std::snprintf(string_buffer.data() + index, 7, "\\u%04X", uint16_t(code));
-                        index += 6;
-                    }
-                    else
-                    {
-                        string_buffer[index++] = ch;
+                        oa.write(string_buffer.data(), index);
+                        index = 0;
                     }
+                    oa.write(first, length);
                 }
             }
 
-            if (string_buffer.size() - index < 7)
+            if (next == last)
+            {
+                break;
+            }
+
+            if (string_buffer.size() - index < max_escape_size)
             {
                 oa.write(string_buffer.data(), index);
                 index = 0;
             }
+            index = static_cast<std::size_t>(write_escape(string_buffer.data() + index, *next) - string_buffer.data());
+            first = next + 1;
         }
 
         if (index > 0)
         {
             oa.write(string_buffer.data(), index);
-            index = 0;
         }
     }
 
 
+private:
+    void grow_indent(const std::size_t new_indent)
+    {
+        if (indent_string.size() < new_indent)
+        {
+            indent_string.resize(std::max(indent_string.size() * 2, new_indent), indent_char);
+        }
+    }
+
 private:
     output_adapter<char_type>&  oa;
     char_type                   indent_char;
     string_t                    indent_string;
-    std::array<char, 21>        number_buffer{ };
+    std::array<char, integer_buffer_size<number_unsigned_t>()> number_buffer{ };
+    std::array<char, float_buffer_size> float_buffer{ };
     std::array<char, 512>       string_buffer{ };
+
+    // a run of a string at most this long is copied into string_buffer
+    static constexpr std::size_t short_run = 32;
 };
 
 
@@ -0,0 +1,295 @@
+#ifndef JSON_SNAPSHOT_HPP
+#define JSON_SNAPSHOT_HPP
+
+#include <atomic>       // atomic
+#include <cstdint>      // uint64_t
+#include <memory>       // shared_ptr, unique_ptr
+#include <mutex>        // mutex, lock_guard
+#include <utility>      // move
+#include <vector>       // vector
+#include "json_release.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_snapshot, a document published by one writer and read by many threads,
+// such as a hot-reloaded config. every version is immutable and reference
+// counted, publish() swaps in the next one.
+//
+// a json_snapshot::reader belongs to one thread and keeps the version it last
+// saw. while that is the newest, get() costs one atomic load of the version
+// number, which only a publish() writes, so readers neither lock nor copy nor
+// write a shared cache line. the first get() after a publish() takes the new
+// version without a lock: the reader announces the version it is about to
+// copy in its hazard slot, and the writer frees a replaced version only when
+// no slot announces it, otherwise at a later publish(). the mutex only
+// orders writers. a reader drops its old version only in that get(), so a
+// reader that stops calling get() keeps the version it last saw alive until
+// it is destroyed. the last owner of a version hands it to json_release_queue,
+// so neither the writer nor a reader pays for freeing it.
+//
+// readers must not modify the document, every const read is safe to share
+//
+template<typename BasicJsonType>
+class json_snapshot
+{
+public:
+    using value_type    = BasicJsonType;
+    using pointer       = std::shared_ptr<const BasicJsonType>;
+    using version_type  = std::uint64_t;
+
+private:
+    // a published version, what m_current points to
+    struct version_node
+    {
+        pointer         document;
+        version_type    version;
+    };
+
+    // the version a reader is copying from. slots are only ever added to the
+    // list, a reader or a load() claims a free one
+    struct hazard_slot
+    {
+        std::atomic<version_node*>  node{ nullptr };
+        std::atomic<bool>           in_use{ false };
+        hazard_slot*                next = nullptr;
+    };
+
+public:
+    class reader
+    {
+    public:
+        explicit reader(const json_snapshot& snapshot)
+            : m_snapshot(&snapshot)
+            , m_slot(snapshot.acquire_slot())
+        {
+            refresh();
+        }
+
+        reader(reader&& other) noexcept
+            : m_snapshot(other.m_snapshot)
+            , m_slot(other.m_slot)
+            , m_current(std::move(other.m_current))
+            , m_version(other.m_version)
+        {
+            other.m_slot = nullptr;
+        }
+
+        reader(const reader&) = delete;
+        reader& operator=(const reader&) = delete;
+
+        ~reader()
+        {
+            if (m_slot != nullptr)
+            {
+                m_slot->in_use.store(false, std::memory_order_release);
+            }
+        }
+
+        // the newest version, valid until the next get() of this reader
+        const BasicJsonType& get()
+        {
+            if (m_snapshot->m_version.load(std::memory_order_acquire) != m_version)
+            {
+                refresh();
+            }
+            return *m_current;
+        }
+
+        const BasicJsonType& operator*()    { return get();     }
+        const BasicJsonType* operator->()   { return &get();    }
+
+        // the version returned by the last get(), kept alive by the caller
+        pointer pin()const              { return m_current; }
+        version_type version()const     { return m_version; }
+
+    private:
+        void refresh()
+        {
+            m_snapshot->read(*m_slot, m_current, m_version);
+        }
+
+    private:
+        const json_snapshot*    m_snapshot;
+        hazard_slot*            m_slot;
+        pointer                 m_current;
+        version_type            m_version = 0;
+    };
+
+public:
+    json_snapshot()
+        : m_current(new version_node{ make(BasicJsonType()), 0 })
+    {
+    }
+
+    explicit json_snapshot(BasicJsonType json)
+        : m_current(new version_node{ make(std::move(json)), 0 })
+    {
+    }
+
+    json_snapshot(const json_snapshot&) = delete;
+    json_snapshot& operator=(const json_snapshot&) = delete;
+
+    // every reader is gone by now
+    ~json_snapshot()
+    {
+        delete m_current.load(std::memory_order_relaxed);
+        for (const auto node : m_retired)
+        {
+            delete node;
+        }
+
+        for (auto slot = m_slots.load(std::memory_order_relaxed); slot != nullptr;)
+        {
+            const auto next = slot->next;
+            delete slot;
+            slot = next;
+        }
+    }
+
+    // the document is moved, not copied, under SJSON_COPY_ON_WRITE a copy of
+    // a working document shares its nodes until the writer changes them
+    version_type publish(BasicJsonType json)
+    {
+        std::unique_ptr<version_node> next(new version_node{ make(std::move(json)), 0 });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_retired.reserve(m_retired.size() + 1);
+
+        const version_type version = m_version.load(std::memory_order_relaxed) + 1;
+        next->version = version;
+        m_retired.push_back(m_current.exchange(next.release()));
+        m_version.store(version, std::memory_order_release);
+
+        reclaim();
+        return version;
+    }
+
+    // the newest version, for a thread without a reader
+    pointer load()const
+    {
+        const auto slot = acquire_slot();
+        pointer document;
+        version_type version = 0;
+        read(*slot, document, version);
+        slot->in_use.store(false, std::memory_order_release);
+        return document;
+    }
+
+    version_type version()const noexcept
+    {
+        return m_version.load(std::memory_order_acquire);
+    }
+
+    reader make_reader()const
+    {
+        return reader(*this);
+    }
+
+private:
+    static pointer make(BasicJsonType&& json)
+    {
+        return pointer(new BasicJsonType(std::move(json)), [](const BasicJsonType* doc)
+        {
+            // the document was created non-const
+            const_cast<BasicJsonType*>(doc)->clear_async();
+            delete doc;
+        });
+    }
+
+    // a free slot, or a new one pushed onto the list
+    hazard_slot* acquire_slot()const
+    {
+        for (auto slot = m_slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+        {
+            bool expected = false;
+            if (!slot->in_use.load(std::memory_order_relaxed) &&
+                slot->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return slot;
+            }
+        }
+
+        const auto slot = new hazard_slot;
+        slot->in_use.store(true, std::memory_order_relaxed);
+        slot->next = m_slots.load(std::memory_order_relaxed);
+        while (!m_slots.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        return slot;
+    }
+
+    // copy the newest version. the node stays alive while the slot announces
+    // it and it is still current after the announcement, which the writer
+    // checks after it has replaced the node
+    void read(hazard_slot& slot, pointer& document, version_type& version)const
+    {
+        version_node* node = m_current.load();
+        while (true)
+        {
+            slot.node.store(node);
+            version_node* const current = m_current.load();
+            if (current == node)
+            {
+                break;
+            }
+            node = current;
+        }
+
+        pointer next = node->document;
+        version = node->version;
+        slot.node.store(nullptr, std::memory_order_release);
+
+        // the old version is released after the slot is cleared
+        document.swap(next);
+    }
+
+    // free the replaced versions no reader is copying from, under m_mutex
+    void reclaim()
+    {
+        auto kept = m_retired.begin();
+        for (const auto node : m_retired)
+        {
+            if (announced(node))
+            {
+                *kept++ = node;
+            }
+            else
+            {
+                delete node;
+            }
+        }
+        m_retired.erase(kept, m_retired.end());
+    }
+
+    bool announced(const version_node* node)const
+    {
+        for (auto slot = m_slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+        {
+            if (slot->node.load() == node)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::mutex                          m_mutex;
+    std::atomic<version_node*>          m_current;
+    std::atomic<version_type>           m_version{ 0 };
+    mutable std::atomic<hazard_slot*>   m_slots{ nullptr };
+    std::vector<version_node*>          m_retired;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_SNAPSHOT_HPP
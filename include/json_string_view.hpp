@@ -0,0 +1,160 @@
+#ifndef JSON_STRING_VIEW_HPP
+#define JSON_STRING_VIEW_HPP
+
+#include <cstddef>      // size_t
+#include <string>       // basic_string, char_traits
+#include <ostream>      // basic_ostream
+#include <algorithm>    // min
+#include <map>          // map
+#if __cplusplus >= 201703L
+#include <string_view>  // basic_string_view
+#endif
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// basic_string_view, a non-owning view of characters that also works in C++11,
+// it converts from and to std::basic_string_view when C++17 is available
+//
+template<typename CharT>
+class basic_string_view
+{
+public:
+    using value_type        = CharT;
+    using traits_type       = std::char_traits<CharT>;
+    using size_type         = std::size_t;
+    using const_pointer     = const CharT*;
+    using const_iterator    = const CharT*;
+
+public:
+    constexpr basic_string_view()noexcept : m_data(nullptr), m_size(0) { }
+
+    constexpr basic_string_view(const CharT* str, size_type len)noexcept : m_data(str), m_size(len) { }
+
+    basic_string_view(const CharT* str) : m_data(str), m_size(traits_type::length(str)) { }
+
+    template<typename Alloc>
+    basic_string_view(const std::basic_string<CharT, traits_type, Alloc>& str)noexcept
+        : m_data(str.data()), m_size(str.size())
+    { }
+
+#if __cplusplus >= 201703L
+    constexpr basic_string_view(std::basic_string_view<CharT> str)noexcept : m_data(str.data()), m_size(str.size()) { }
+
+    constexpr operator std::basic_string_view<CharT>()const noexcept
+    {
+        return std::basic_string_view<CharT>(m_data, m_size);
+    }
+#endif
+
+    template<typename Alloc>
+    explicit operator std::basic_string<CharT, traits_type, Alloc>()const
+    {
+        return std::basic_string<CharT, traits_type, Alloc>(m_data, m_size);
+    }
+
+    std::basic_string<CharT> to_string()const
+    {
+        return std::basic_string<CharT>(m_data, m_size);
+    }
+
+
+public:
+    constexpr const_pointer data()const noexcept    { return m_data;            }
+    constexpr size_type size()const noexcept        { return m_size;            }
+    constexpr size_type length()const noexcept      { return m_size;            }
+    constexpr bool empty()const noexcept            { return m_size == 0;       }
+    constexpr const_iterator begin()const noexcept  { return m_data;            }
+    constexpr const_iterator end()const noexcept    { return m_data + m_size;   }
+
+    constexpr const CharT& operator[](size_type index)const noexcept
+    {
+        return m_data[index];
+    }
+
+    int compare(basic_string_view other)const noexcept
+    {
+        const int result = traits_type::compare(m_data, other.m_data, (std::min)(m_size, other.m_size));
+        if (result != 0)
+        {
+            return result;
+        }
+
+        return m_size == other.m_size ? 0 : (m_size < other.m_size ? -1 : 1);
+    }
+
+
+public:
+    friend bool operator==(basic_string_view lhs, basic_string_view rhs)noexcept
+    {
+        return lhs.m_size == rhs.m_size && traits_type::compare(lhs.m_data, rhs.m_data, lhs.m_size) == 0;
+    }
+
+    friend bool operator!=(basic_string_view lhs, basic_string_view rhs)noexcept { return !(lhs == rhs);          }
+    friend bool operator< (basic_string_view lhs, basic_string_view rhs)noexcept { return lhs.compare(rhs) < 0;   }
+    friend bool operator<=(basic_string_view lhs, basic_string_view rhs)noexcept { return lhs.compare(rhs) <= 0;  }
+    friend bool operator> (basic_string_view lhs, basic_string_view rhs)noexcept { return lhs.compare(rhs) > 0;   }
+    friend bool operator>=(basic_string_view lhs, basic_string_view rhs)noexcept { return lhs.compare(rhs) >= 0;  }
+
+    friend std::basic_ostream<CharT>& operator<<(std::basic_ostream<CharT>& os, basic_string_view view)
+    {
+        return os.write(view.m_data, static_cast<std::streamsize>(view.m_size));
+    }
+
+
+private:
+    const CharT*    m_data;
+    size_type       m_size;
+};
+
+
+
+//
+// json_key_less, the key order of objects. it is transparent, so since C++14
+// a key given as a basic_string_view is looked up without building a key
+//
+template<typename KeyType, typename StringType>
+struct json_key_less
+{
+    using is_transparent    = void;
+    using view_type         = basic_string_view<typename StringType::value_type>;
+    using string_type       = StringType;
+
+    bool operator()(const KeyType& lhs, const KeyType& rhs)const  { return lhs < rhs; }
+    bool operator()(const KeyType& lhs, view_type rhs)const       { return view_type(static_cast<const string_type&>(lhs)) < rhs; }
+    bool operator()(view_type lhs, const KeyType& rhs)const       { return lhs < view_type(static_cast<const string_type&>(rhs)); }
+};
+
+
+//
+// json_object_type, the object type of basic_json. a std::map orders its keys
+// with json_key_less, any other ObjectType keeps its own defaults and is
+// looked up through a built key
+//
+template<template<typename, typename, typename...> class ObjectType, typename KeyType, typename ValueType, typename StringType>
+struct json_object_type
+{
+    using type = ObjectType<KeyType, ValueType>;
+
+    static constexpr bool transparent = false;
+};
+
+template<typename KeyType, typename ValueType, typename StringType>
+struct json_object_type<std::map, KeyType, ValueType, StringType>
+{
+    using type = std::map<KeyType, ValueType, json_key_less<KeyType, StringType>>;
+
+    static constexpr bool transparent = true;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_STRING_VIEW_HPP
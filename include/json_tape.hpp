@@ -0,0 +1,892 @@
+#ifndef JSON_TAPE_HPP
+#define JSON_TAPE_HPP
+
+#include <cstdio>       // FILE
+#include <cstdint>      // uint64_t
+#include <cstring>      // memcpy
+#include <vector>       // vector
+#include <iterator>     // forward_iterator_tag
+#include <limits>       // numeric_limits
+#include <stdexcept>    // out_of_range
+#include "json_value.hpp"
+#include "json_parser.hpp"
+#include "json_string_view.hpp"
+#include "json_exception.hpp"
+
+namespace sjson
+{
+
+namespace detail
+{
+
+
+//
+// json_tape, an immutable document stored in one flat array of 64-bit
+// entries and one string arena
+//
+// every entry holds a tag in its high 8 bits and a payload in the low 56 bits
+//   null, true, false           [tag]
+//   integer, unsigned, float    [tag][raw 64 bits]
+//   string, big integer         [tag | arena offset][length]
+//   object                      [{ | index of }][member count] key value ... [} | index of {]
+//   array                       [[ | index of ]][element count] value ... [index of each value] [] | index of []
+//
+// so a container is skipped in O(1), and the index table at the end of an
+// array gives O(1) access to any element
+//
+
+enum class tape_tag : std::uint8_t
+{
+    null            = 'n',
+    true_value      = 't',
+    false_value     = 'f',
+    integer         = 'l',
+    unsigned_integer= 'u',
+    big_integer     = 'b',
+    floating        = 'd',
+    string          = '"',
+    begin_object    = '{',
+    end_object      = '}',
+    begin_array     = '[',
+    end_array       = ']'
+};
+
+
+struct tape_entry
+{
+    static constexpr std::uint64_t payload_mask = 0x00FFFFFFFFFFFFFFull;
+
+    static std::uint64_t make(const tape_tag tag, const std::uint64_t payload = 0)noexcept
+    {
+        return (static_cast<std::uint64_t>(tag) << 56) | payload;
+    }
+
+    static tape_tag tag(const std::uint64_t entry)noexcept
+    {
+        return static_cast<tape_tag>(entry >> 56);
+    }
+
+    static std::size_t payload(const std::uint64_t entry)noexcept
+    {
+        return static_cast<std::size_t>(entry & payload_mask);
+    }
+};
+
+
+template<typename BasicJsonType>
+class json_tape;
+
+template<typename BasicJsonType>
+class json_tape_view;
+
+
+
+//
+// json_tape_builder, the parser handler that writes a json_tape
+//
+
+template<typename BasicJsonType>
+class json_tape_builder
+{
+public:
+    using string_t          = typename BasicJsonType::string_t;
+    using number_integer_t  = typename BasicJsonType::number_integer_t;
+    using number_unsigned_t = typename BasicJsonType::number_unsigned_t;
+    using number_float_t    = typename BasicJsonType::number_float_t;
+    using boolean_t         = typename BasicJsonType::boolean_t;
+
+public:
+    explicit json_tape_builder(json_tape<BasicJsonType>& tape)
+        : entries(tape.m_entries), strings(tape.m_strings)
+    { }
+
+    void null_value()
+    {
+        element();
+        entries.push_back(tape_entry::make(tape_tag::null));
+    }
+
+    void boolean_value(const boolean_t val)
+    {
+        element();
+        entries.push_back(tape_entry::make(val ? tape_tag::true_value : tape_tag::false_value));
+    }
+
+    void integer_value(const number_integer_t num)
+    {
+        element();
+        entries.push_back(tape_entry::make(tape_tag::integer));
+        entries.push_back(static_cast<std::uint64_t>(static_cast<std::int64_t>(num)));
+    }
+
+    void unsigned_value(const number_unsigned_t num)
+    {
+        element();
+        entries.push_back(tape_entry::make(tape_tag::unsigned_integer));
+        entries.push_back(static_cast<std::uint64_t>(num));
+    }
+
+    void big_integer_value(const string_t& str)
+    {
+        element();
+        push_string(str, tape_tag::big_integer);
+    }
+
+    void float_value(const number_float_t num)
+    {
+        const double val = static_cast<double>(num);
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &val, sizeof(bits));
+
+        element();
+        entries.push_back(tape_entry::make(tape_tag::floating));
+        entries.push_back(bits);
+    }
+
+    void string_value(const string_t& str)
+    {
+        element();
+        push_string(str);
+    }
+
+    void key(const string_t& str)
+    {
+        ++entries[open.back() + 1];
+        push_string(str);
+    }
+
+    void begin_object()
+    {
+        element();
+        open.push_back(entries.size());
+        entries.push_back(tape_entry::make(tape_tag::begin_object));
+        entries.push_back(0);
+    }
+
+    void end_object()
+    {
+        const auto begin = open.back();
+        open.pop_back();
+
+        entries[begin] = tape_entry::make(tape_tag::begin_object, entries.size());
+        entries.push_back(tape_entry::make(tape_tag::end_object, begin));
+    }
+
+    void begin_array()
+    {
+        element();
+        open.push_back(entries.size());
+        entries.push_back(tape_entry::make(tape_tag::begin_array));
+        entries.push_back(0);
+    }
+
+    void end_array()
+    {
+        const auto begin = open.back();
+        open.pop_back();
+
+        // move the index of every element behind the elements
+        const auto count = static_cast<std::size_t>(entries[begin + 1]);
+        entries.insert(entries.end(), elements.end() - count, elements.end());
+        elements.resize(elements.size() - count);
+
+        entries[begin] = tape_entry::make(tape_tag::begin_array, entries.size());
+        entries.push_back(tape_entry::make(tape_tag::end_array, begin));
+    }
+
+private:
+    // count a value that is about to be written into an array
+    void element()
+    {
+        if (!open.empty() && tape_entry::tag(entries[open.back()]) == tape_tag::begin_array)
+        {
+            ++entries[open.back() + 1];
+            elements.push_back(entries.size());
+        }
+    }
+
+    void push_string(const string_t& str, const tape_tag tag = tape_tag::string)
+    {
+        entries.push_back(tape_entry::make(tag, strings.size()));
+        entries.push_back(str.size());
+        strings.append(str);
+    }
+
+private:
+    std::vector<std::uint64_t>& entries;
+    string_t&                   strings;
+    std::vector<std::size_t>    open;       // begin entries of the open containers
+    std::vector<std::uint64_t>  elements;   // element entries of the open arrays
+};
+
+
+
+//
+// json_tape_iterator, a forward iterator that yields json_tape_view
+//
+
+template<typename BasicJsonType>
+class json_tape_iterator
+{
+public:
+    using char_type         = typename BasicJsonType::char_type;
+    using string_view_type  = basic_string_view<char_type>;
+
+    using value_type        = json_tape_view<BasicJsonType>;
+    using difference_type   = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+    using pointer           = const value_type*;
+    using reference         = value_type;
+
+public:
+    json_tape_iterator(const json_tape<BasicJsonType>* tape, std::size_t pos, bool is_object)noexcept
+        : m_tape(tape), m_pos(pos), m_is_object(is_object)
+    { }
+
+    reference operator*()const
+    {
+        return value_type(m_tape, m_is_object ? m_pos + 2 : m_pos);
+    }
+
+    string_view_type key()const
+    {
+        if (!m_is_object)
+        {
+            throw json_invalid_iterator("cannot use key() with non-object type");
+        }
+
+        return value_type(m_tape, m_pos).as_string();
+    }
+
+    reference value()const
+    {
+        return operator*();
+    }
+
+    json_tape_iterator& operator++()noexcept
+    {
+        m_pos = m_tape->next(m_is_object ? m_pos + 2 : m_pos);
+        return *this;
+    }
+
+    json_tape_iterator operator++(int)noexcept
+    {
+        auto old = *this;
+        ++(*this);
+        return old;
+    }
+
+    friend bool operator==(const json_tape_iterator& lhs, const json_tape_iterator& rhs)noexcept
+    {
+        return lhs.m_tape == rhs.m_tape && lhs.m_pos == rhs.m_pos;
+    }
+
+    friend bool operator!=(const json_tape_iterator& lhs, const json_tape_iterator& rhs)noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    const json_tape<BasicJsonType>* m_tape;
+    std::size_t                     m_pos;
+    bool                            m_is_object;
+};
+
+
+
+//
+// json_tape_view, a lightweight non-owning view of one value in a json_tape,
+// it is valid as long as the tape is alive
+//
+
+template<typename BasicJsonType>
+class json_tape_view
+{
+public:
+    using char_type         = typename BasicJsonType::char_type;
+    using string_t          = typename BasicJsonType::string_t;
+    using number_integer_t  = typename BasicJsonType::number_integer_t;
+    using number_unsigned_t = typename BasicJsonType::number_unsigned_t;
+    using number_float_t    = typename BasicJsonType::number_float_t;
+    using boolean_t         = typename BasicJsonType::boolean_t;
+    using size_type         = std::size_t;
+    using string_view_type  = basic_string_view<char_type>;
+    using iterator          = json_tape_iterator<BasicJsonType>;
+    using const_iterator    = iterator;
+
+public:
+    json_tape_view(const json_tape<BasicJsonType>* tape, size_type index)noexcept
+        : m_tape(tape), m_index(index)
+    { }
+
+
+public:
+    value_t type()const noexcept
+    {
+        switch (tag())
+        {
+            case tape_tag::true_value:
+            case tape_tag::false_value:
+                return value_t::boolean;
+
+            case tape_tag::integer:
+                return value_t::number_integer;
+
+            case tape_tag::unsigned_integer:
+                return value_t::number_unsigned;
+
+            case tape_tag::big_integer:
+                return value_t::number_big_integer;
+
+            case tape_tag::floating:
+                return value_t::number_float;
+
+            case tape_tag::string:
+                return value_t::string;
+
+            case tape_tag::begin_object:
+                return value_t::object;
+
+            case tape_tag::begin_array:
+                return value_t::array;
+
+            default:
+                return value_t::null;
+        }
+    }
+
+    bool is_null()const noexcept    { return type() == value_t::null;           }
+
+    bool is_object()const noexcept  { return type() == value_t::object;         }
+
+    bool is_array()const noexcept   { return type() == value_t::array;          }
+
+    bool is_string()const noexcept  { return type() == value_t::string;         }
+
+    bool is_integer()const noexcept { return type() == value_t::number_integer || is_unsigned(); }
+
+    bool is_unsigned()const noexcept    { return type() == value_t::number_unsigned;    }
+
+    bool is_big_integer()const noexcept { return type() == value_t::number_big_integer; }
+
+    bool is_float()const noexcept   { return type() == value_t::number_float;   }
+
+    bool is_number()const noexcept  { return is_integer() || is_big_integer() || is_float(); }
+
+    bool is_bool()const noexcept    { return type() == value_t::boolean;        }
+
+
+    size_type size()const noexcept
+    {
+        switch (tag())
+        {
+            case tape_tag::null:
+                return 0;
+
+            case tape_tag::string:
+            case tape_tag::begin_object:
+            case tape_tag::begin_array:
+                return static_cast<size_type>(entry(m_index + 1));
+
+            default:
+                return 1;
+        }
+    }
+
+    bool empty()const noexcept
+    {
+        return size() == 0;
+    }
+
+
+public:
+    iterator begin()const noexcept
+    {
+        switch (tag())
+        {
+            case tape_tag::begin_object:
+                return iterator(m_tape, m_index + 2, true);
+
+            case tape_tag::begin_array:
+                return iterator(m_tape, m_index + 2, false);
+
+            default:
+                return iterator(m_tape, m_index, false);
+        }
+    }
+
+    iterator end()const noexcept
+    {
+        switch (tag())
+        {
+            case tape_tag::begin_object:
+                return iterator(m_tape, tape_entry::payload(entry(m_index)), true);
+
+            case tape_tag::begin_array:
+                return iterator(m_tape, tape_entry::payload(entry(m_index)) - size(), false);
+
+            default:
+                return iterator(m_tape, m_tape->next(m_index), false);
+        }
+    }
+
+
+public:
+    iterator find(const string_view_type key)const
+    {
+        if (!is_object())
+        {
+            return end();
+        }
+
+        auto iter = begin();
+        const auto last = end();
+        for (; iter != last; ++iter)
+        {
+            if (iter.key() == key)
+            {
+                break;
+            }
+        }
+
+        return iter;
+    }
+
+    bool contains(const string_view_type key)const
+    {
+        return find(key) != end();
+    }
+
+    json_tape_view operator[](size_type index)const
+    {
+        if (!is_array())
+        {
+            throw json_invalid_key("json operator[] called on a non-array object");
+        }
+
+        const auto count = size();
+        if (index >= count)
+        {
+            throw std::out_of_range("json operator[] index out of range");
+        }
+
+        const auto table = tape_entry::payload(entry(m_index)) - count;
+        return json_tape_view(m_tape, static_cast<size_type>(entry(table + index)));
+    }
+
+    json_tape_view operator[](const string_view_type key)const
+    {
+        if (!is_object())
+        {
+            throw json_invalid_key("json operator[] called on a non-object type");
+        }
+
+        auto iter = find(key);
+        if (iter == end())
+        {
+            throw json_invalid_key("json operator[] key out of range");
+        }
+
+        return *iter;
+    }
+
+    json_tape_view at(size_type index)const
+    {
+        return operator[](index);
+    }
+
+    json_tape_view at(const string_view_type key)const
+    {
+        return operator[](key);
+    }
+
+
+public:
+    string_view_type as_string()const
+    {
+        if (!is_string())
+        {
+            throw json_type_error("json value type must be string");
+        }
+
+        return arena_text();
+    }
+
+    // the decimal text of a big integer
+    string_view_type as_big_integer()const
+    {
+        if (!is_big_integer())
+        {
+            throw json_type_error("json value type must be big integer");
+        }
+
+        return arena_text();
+    }
+
+    number_integer_t as_int()const
+    {
+        switch (tag())
+        {
+        case tape_tag::integer:
+            return static_cast<number_integer_t>(static_cast<std::int64_t>(entry(m_index + 1)));
+
+        case tape_tag::unsigned_integer:
+            if (entry(m_index + 1) > static_cast<std::uint64_t>(std::numeric_limits<number_integer_t>::max()))
+            {
+                throw json_type_error("json unsigned integer does not fit in an integer");
+            }
+            return static_cast<number_integer_t>(entry(m_index + 1));
+
+        case tape_tag::floating:
+            return static_cast<number_integer_t>(float_entry());
+
+        case tape_tag::big_integer:
+            throw json_type_error("json big integer does not fit in an integer");
+
+        default:
+            throw json_type_error("json value type must be number");
+        }
+    }
+
+    number_unsigned_t as_unsigned()const
+    {
+        switch (tag())
+        {
+        case tape_tag::integer:
+        case tape_tag::unsigned_integer:
+            return static_cast<number_unsigned_t>(entry(m_index + 1));
+
+        case tape_tag::floating:
+            return static_cast<number_unsigned_t>(float_entry());
+
+        case tape_tag::big_integer:
+            throw json_type_error("json big integer does not fit in an unsigned integer");
+
+        default:
+            throw json_type_error("json value type must be number");
+        }
+    }
+
+    number_float_t as_float()const
+    {
+        switch (tag())
+        {
+        case tape_tag::integer:
+            return static_cast<number_float_t>(static_cast<std::int64_t>(entry(m_index + 1)));
+
+        case tape_tag::unsigned_integer:
+            return static_cast<number_float_t>(entry(m_index + 1));
+
+        case tape_tag::floating:
+            return static_cast<number_float_t>(float_entry());
+
+        case tape_tag::big_integer:
+        {
+            const auto text = arena_text();
+            return typename BasicJsonType::number_big_integer_t(string_t(text.data(), text.size())).template to_float<number_float_t>();
+        }
+
+        default:
+            throw json_type_error("json value type must be number");
+        }
+    }
+
+    boolean_t as_bool()const
+    {
+        switch (tag())
+        {
+        case tape_tag::true_value:
+            return true;
+
+        case tape_tag::begin_object:
+        case tape_tag::begin_array:
+        case tape_tag::string:
+            return empty();
+
+        case tape_tag::integer:
+        case tape_tag::unsigned_integer:
+        case tape_tag::floating:
+            return as_float() != 0.0;
+
+        case tape_tag::big_integer:
+            return as_big_integer() != string_view_type("0");
+
+        default:
+            return false;
+        }
+    }
+
+
+public:
+    // emit the value as parser handler events
+    template<typename Handler>
+    void walk(Handler& handler)const
+    {
+        switch (tag())
+        {
+        case tape_tag::true_value:
+        case tape_tag::false_value:
+            handler.boolean_value(tag() == tape_tag::true_value);
+            return;
+
+        case tape_tag::integer:
+            handler.integer_value(as_int());
+            return;
+
+        case tape_tag::unsigned_integer:
+            handler.unsigned_value(as_unsigned());
+            return;
+
+        case tape_tag::big_integer:
+        {
+            const auto text = as_big_integer();
+            handler.big_integer_value(string_t(text.data(), text.size()));
+            return;
+        }
+
+        case tape_tag::floating:
+            handler.float_value(as_float());
+            return;
+
+        case tape_tag::string:
+        {
+            const auto str = as_string();
+            handler.string_value(string_t(str.data(), str.size()));
+            return;
+        }
+
+        case tape_tag::begin_object:
+        {
+            handler.begin_object();
+            for (auto iter = begin(), last = end(); iter != last; ++iter)
+            {
+                const auto key = iter.key();
+                handler.key(string_t(key.data(), key.size()));
+                iter.value().walk(handler);
+            }
+            handler.end_object();
+            return;
+        }
+
+        case tape_tag::begin_array:
+        {
+            handler.begin_array();
+            for (auto iter = begin(), last = end(); iter != last; ++iter)
+            {
+                (*iter).walk(handler);
+            }
+            handler.end_array();
+            return;
+        }
+
+        default:
+            handler.null_value();
+            return;
+        }
+    }
+
+    BasicJsonType to_json()const
+    {
+        json_dom_builder<BasicJsonType> builder;
+        walk(builder);
+        return std::move(builder.result());
+    }
+
+
+private:
+    std::uint64_t entry(size_type index)const noexcept
+    {
+        return m_tape->m_entries[index];
+    }
+
+    tape_tag tag()const noexcept
+    {
+        return tape_entry::tag(entry(m_index));
+    }
+
+    string_view_type arena_text()const noexcept
+    {
+        const auto& strings = m_tape->m_strings;
+        return string_view_type(strings.data() + tape_entry::payload(entry(m_index)),
+                                static_cast<size_type>(entry(m_index + 1)));
+    }
+
+    double float_entry()const noexcept
+    {
+        const auto bits = entry(m_index + 1);
+        double val = 0.0;
+        std::memcpy(&val, &bits, sizeof(val));
+        return val;
+    }
+
+private:
+    const json_tape<BasicJsonType>* m_tape;
+    size_type                       m_index;
+};
+
+
+
+//
+// json_tape
+//
+
+template<typename BasicJsonType>
+class json_tape
+{
+public:
+    friend class json_tape_builder<BasicJsonType>;
+    friend class json_tape_iterator<BasicJsonType>;
+    friend class json_tape_view<BasicJsonType>;
+
+    using char_type     = typename BasicJsonType::char_type;
+    using string_t      = typename BasicJsonType::string_t;
+    using size_type     = std::size_t;
+    using view_type     = json_tape_view<BasicJsonType>;
+
+public:
+    // an empty tape holds a null
+    json_tape()
+        : m_entries(1, tape_entry::make(tape_tag::null))
+    { }
+
+    static json_tape parse(const string_t& str)
+    {
+        string_input_adapter<string_t> adapter(str);
+        return parse(adapter);
+    }
+
+    static json_tape parse(const char_type* str)
+    {
+        buffer_input_adapter<char_type> adapter(str);
+        return parse(adapter);
+    }
+
+    static json_tape parse(std::FILE* file)
+    {
+        file_input_adapter<char_type> adapter(file);
+        return parse(adapter);
+    }
+
+    static json_tape from_json(const BasicJsonType& json)
+    {
+        json_tape tape;
+        tape.m_entries.clear();
+
+        json_tape_builder<BasicJsonType> builder(tape);
+        append(json, builder);
+        return tape;
+    }
+
+    BasicJsonType to_json()const
+    {
+        return root().to_json();
+    }
+
+    view_type root()const noexcept
+    {
+        return view_type(this, 0);
+    }
+
+    // number of 64-bit entries and of string arena characters
+    size_type tape_size()const noexcept     { return m_entries.size();  }
+    size_type arena_size()const noexcept    { return m_strings.size();  }
+
+
+private:
+    static json_tape parse(input_adapter<char_type>& adapter)
+    {
+        json_tape tape;
+        tape.m_entries.clear();
+
+        json_tape_builder<BasicJsonType> builder(tape);
+        json_parser<BasicJsonType>(adapter).parse(builder);
+        return tape;
+    }
+
+    static void append(const BasicJsonType& json, json_tape_builder<BasicJsonType>& builder)
+    {
+        switch (json.type())
+        {
+        case value_t::object:
+            builder.begin_object();
+            for (const auto& member : json.as_object())
+            {
+                builder.key(member.first);
+                append(member.second, builder);
+            }
+            builder.end_object();
+            return;
+
+        case value_t::array:
+            builder.begin_array();
+            // iterated, so a packed array is read without a general copy
+            for (const auto& element : json)
+            {
+                append(element, builder);
+            }
+            builder.end_array();
+            return;
+
+        case value_t::string:
+            builder.string_value(json.as_string());
+            return;
+
+        case value_t::number_integer:
+            builder.integer_value(json.as_int());
+            return;
+
+        case value_t::number_unsigned:
+            builder.unsigned_value(json.as_unsigned());
+            return;
+
+        case value_t::number_big_integer:
+            builder.big_integer_value(json.as_big_integer().str());
+            return;
+
+        case value_t::number_float:
+            builder.float_value(json.as_float());
+            return;
+
+        case value_t::boolean:
+            builder.boolean_value(json.as_bool());
+            return;
+
+        default:
+            builder.null_value();
+            return;
+        }
+    }
+
+    // the entry after the value that starts at index
+    size_type next(size_type index)const noexcept
+    {
+        const auto entry = m_entries[index];
+        switch (tape_entry::tag(entry))
+        {
+            case tape_tag::integer:
+            case tape_tag::unsigned_integer:
+            case tape_tag::big_integer:
+            case tape_tag::floating:
+            case tape_tag::string:
+                return index + 2;
+
+            case tape_tag::begin_object:
+            case tape_tag::begin_array:
+                return tape_entry::payload(entry) + 1;
+
+            default:
+                return index + 1;
+        }
+    }
+
+private:
+    std::vector<std::uint64_t>  m_entries;
+    string_t                    m_strings;
+};
+
+
+} // namespace detail
+
+} // namespace sjson
+
+#endif // JSON_TAPE_HPP
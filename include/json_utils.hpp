@@ -3,6 +3,9 @@
 
 #include <type_traits>  // enable_if false_type true_type
 #include <iostream>     // basic_ostream basic_istream
+#include <memory>       // allocator
+#include <cstddef>      // size_t
+#include <utility>      // declval
 
 namespace sjson
 {
@@ -17,14 +20,15 @@ template<
         class StringType = std::string,
         class IntegerType = std::int64_t,
         class FloatType = double,
-        class BooleanType = bool
+        class BooleanType = bool,
+        template<typename T> class AllocatorType = std::allocator
         >
 class basic_json;
 
 
 
 template<class StringType = std::string>
-using str_json = basic_json<std::map, std::vector, StringType, std::int64_t, double, bool>;
+using str_json = basic_json<std::map, std::vector, StringType, std::int64_t, double, bool, std::allocator>;
 
 
 
@@ -36,13 +40,15 @@ template<                                                               \
         class StringType,                                               \
         class NumberIntegerType,                                        \
         class NumberFloatType,                                          \
-        class BooleanType                                               \
+        class BooleanType,                                              \
+        template<typename> class AllocatorType                          \
         > 
 
 
 #define BASIC_JSON_TEMPLATE_ARGS                        \
     ObjectType, ArrayType, StringType,                  \
-    NumberIntegerType, NumberFloatType, BooleanType
+    NumberIntegerType, NumberFloatType, BooleanType,    \
+    AllocatorType
 
 
 
@@ -60,6 +66,86 @@ using void_t = typename make_void<T...>::type;
 
 
 
+// 
+// reserve_container, capacity_of, shrink_container
+// 
+// containers without the member (std::map) ignore reserve and shrink,
+// and their capacity is their size
+// 
+template<typename Container, typename = void>
+struct has_reserve
+    : std::false_type
+{
+};
+
+template<typename Container>
+struct has_reserve<Container, void_t<decltype(std::declval<Container&>().reserve(std::size_t()))>>
+    : std::true_type
+{
+};
+
+template<typename Container, typename = void>
+struct has_capacity
+    : std::false_type
+{
+};
+
+template<typename Container>
+struct has_capacity<Container, void_t<decltype(std::declval<const Container&>().capacity())>>
+    : std::true_type
+{
+};
+
+template<typename Container, typename = void>
+struct has_shrink_to_fit
+    : std::false_type
+{
+};
+
+template<typename Container>
+struct has_shrink_to_fit<Container, void_t<decltype(std::declval<Container&>().shrink_to_fit())>>
+    : std::true_type
+{
+};
+
+template<typename Container>
+inline void reserve_container(Container& container, const std::size_t count, std::true_type)   { container.reserve(count); }
+
+template<typename Container>
+inline void reserve_container(Container&, const std::size_t, std::false_type)                   { }
+
+template<typename Container>
+inline void reserve_container(Container& container, const std::size_t count)
+{
+    reserve_container(container, count, has_reserve<Container>());
+}
+
+template<typename Container>
+inline std::size_t capacity_of(const Container& container, std::true_type)     { return container.capacity(); }
+
+template<typename Container>
+inline std::size_t capacity_of(const Container& container, std::false_type)    { return container.size(); }
+
+template<typename Container>
+inline std::size_t capacity_of(const Container& container)
+{
+    return capacity_of(container, has_capacity<Container>());
+}
+
+template<typename Container>
+inline void shrink_container(Container& container, std::true_type)     { container.shrink_to_fit(); }
+
+template<typename Container>
+inline void shrink_container(Container&, std::false_type)               { }
+
+template<typename Container>
+inline void shrink_container(Container& container)
+{
+    shrink_container(container, has_shrink_to_fit<Container>());
+}
+
+
+
 // 
 // is_basic_json
 //
@@ -1,12 +1,86 @@
 #ifndef JSON_VALUE_HPP
 #define JSON_VALUE_HPP
 
-#include <cstdint>  // uint8_t
+#include <cstdint>  // uint8_t, uint64_t
 #include <cstddef>  // nullptr_t
+#include <cstring>  // memcpy
+#include <limits>   // numeric_limits
 #include <utility>  // forward
+#include <atomic>   // atomic
+#include <vector>   // vector
+#include <memory>   // allocator_traits
+#include <functional> // hash
+#include <algorithm>  // mismatch
+#include <unordered_set> // unordered_set
+#include "json_big_integer.hpp"
+#include "json_memory.hpp"
 #include "json_exception.hpp"
 
 
+//
+// SJSON_COMPACT_VALUE
+//
+// define it before including json.hpp to store every json value in a single
+// 64-bit word: doubles are stored as is, the other types are NaN-boxed, so
+// null, boolean, double and integers in [-2^47, 2^47) need no heap block
+//
+// SJSON_COPY_ON_WRITE
+//
+// define it before including json.hpp to share objects, arrays and strings
+// between copies, copying a json is O(1) and a container is cloned (shallowly)
+// the first time it is accessed through a non-const function while shared,
+// so changing a copied document only clones the path to the changed node.
+// a container that has handed out a mutable reference or iterator (operator[],
+// at, begin...) is pinned: it is cloned instead of shared when copied, so the
+// reference never writes into another copy
+//
+// SJSON_ATOM_KEYS
+//
+// define it before including json.hpp to store object keys as json_atom:
+// every key is interned once in a process-wide table and objects hold a
+// pointer to it, so equal keys compare by address and share their memory
+//
+// SJSON_PACKED_ARRAYS
+//
+// define it before including json.hpp to let the parser store an array whose
+// elements are all integers, all floats or all booleans as a packed vector
+// (json_packed_array), readable without copies through basic_json::as_span().
+// push_back() and pop_back() of the same element type keep it packed, any
+// other change, and any non-const access that hands out a reference to an
+// element (operator[], at, iterators...), turns it back into a general array
+// first. const access never changes it: a const iterator copies the element
+// it points at into itself, const operator[] and at() build general elements
+// 64 at a time, and as_array() a general copy of the whole array, kept until
+// the array changes and safe to build from several threads at once
+//
+// SJSON_BIG_INTEGERS
+//
+// define it before including json.hpp to parse integers outside the range
+// of number_integer_t and number_unsigned_t as json_big_integer, kept exactly.
+// without it they are parsed as floats
+//
+// SJSON_HASH_CACHE
+//
+// define it before including json.hpp to keep the structural hash of an
+// object or array in its node once basic_json::hash() has computed it, so a
+// document is hashed again only along the paths that changed. any change of
+// a container clears its hash, and a container that has handed out a mutable
+// reference or iterator is never cached, as it can change behind its back
+//
+// SJSON_MEMORY_STATS
+//
+// define it before including json.hpp to count every node allocated and freed
+// through create() and destroy() in json_allocation_stats. the counters are
+// process-wide relaxed atomics, so every allocation touches a shared cache line
+//
+// SJSON_NO_SIMD
+//
+// define it before including json.hpp to scan strings for characters to
+// escape one at a time, instead of with the SSE2 or AVX2 instructions the
+// compiler targets
+//
+
+
 namespace sjson
 {
 
@@ -22,7 +96,36 @@ enum class value_t : std::uint8_t
     string,
     number_integer,
     number_float,
-    boolean
+    boolean,
+    number_unsigned,        // an unsigned integer above the range of number_integer_t
+    number_big_integer      // an integer of any width, json_big_integer
+};
+
+
+template<typename IntegerType, typename FloatType, typename BooleanType, typename ArrayType>
+class json_packed_array;
+
+
+
+// 
+// json_node, the heap block behind an object, array or string
+// 
+template<typename Ty>
+struct json_node
+{
+    template<typename... Args>
+    explicit json_node(Args&&... args) : value(std::forward<Args>(args)...) { }
+
+    Ty                          value;
+#if defined(SJSON_COPY_ON_WRITE)
+    std::atomic<std::size_t>    ref_count{ 1 };
+#endif
+#if defined(SJSON_COPY_ON_WRITE) || defined(SJSON_HASH_CACHE)
+    bool                        pinned = false;
+#endif
+#if defined(SJSON_HASH_CACHE)
+    std::atomic<std::size_t>    hash{ 0 };      // 0 until it is computed
+#endif
 };
 
 
@@ -36,113 +139,141 @@ public:
     using array_t           = typename BasicJsonType::array_t;
     using string_t          = typename BasicJsonType::string_t;;
     using number_integer_t  = typename BasicJsonType::number_integer_t;
+    using number_unsigned_t = typename BasicJsonType::number_unsigned_t;
+    using number_big_integer_t = typename BasicJsonType::number_big_integer_t;
     using number_float_t    = typename BasicJsonType::number_float_t;
     using boolean_t         = typename BasicJsonType::boolean_t;
+    using allocator_type    = typename BasicJsonType::allocator_type;
+    using packed_t          = json_packed_array<number_integer_t, number_float_t, boolean_t, array_t>;
+
+    template<typename Ty>
+    using node_allocator    = typename std::allocator_traits<allocator_type>::template rebind_alloc<json_node<Ty>>;
+
+    template<typename Ty>
+    using node_traits       = std::allocator_traits<node_allocator<Ty>>;
 
 public:
     json_value()
     {
-        m_type = value_t::null;
-        m_data.object = nullptr;
+        set_null();
     }
 
     json_value(std::nullptr_t)
     {
-        m_type = value_t::null;
-        m_data.object = nullptr;
+        set_null();
     }
 
     json_value(const object_t& obj)
     {
-        m_type = value_t::object;
-        m_data.object = create<object_t>(obj);
+        set_object(create<object_t>(obj));
     }
 
     json_value(object_t&& obj)
     {
-        m_type = value_t::object;
-        m_data.object = create<object_t>(std::move(obj));
+        set_object(create<object_t>(std::move(obj)));
     }
 
     json_value(const array_t& arr)
     {
-        m_type = value_t::array;
-        m_data.array = create<array_t>(arr);
+        set_array(create<array_t>(arr));
     }
 
     json_value(array_t&& arr)
     {
-        m_type = value_t::array;
-        m_data.array = create<array_t>(std::move(arr));
+        set_array(create<array_t>(std::move(arr)));
     }
 
     json_value(const string_t& str)
     {
-        m_type = value_t::string;
-        m_data.string = create<string_t>(str);
+        set_string(create<string_t>(str));
     }
 
     json_value(string_t&& str)
     {
-        m_type = value_t::string;
-        m_data.string = create<string_t>(std::move(str));
+        set_string(create<string_t>(std::move(str)));
     }
 
     json_value(const char_type* str)
     {
-        m_type = value_t::string;
-        m_data.string = create<string_t>(str);
+        set_string(create<string_t>(str));
     }
 
     json_value(const number_integer_t num)
     {
-        m_type = value_t::number_integer;
-        m_data.number_integer = num;
+        set_integer(num);
+    }
+
+    // an unsigned value in the range of number_integer_t is stored as an integer
+    json_value(const number_unsigned_t num)
+    {
+        if (num <= static_cast<number_unsigned_t>(std::numeric_limits<number_integer_t>::max()))
+        {
+            set_integer(static_cast<number_integer_t>(num));
+        }
+        else
+        {
+            set_unsigned(num);
+        }
+    }
+
+    json_value(const number_big_integer_t& num)
+    {
+        set_big_integer(create<number_big_integer_t>(num));
+    }
+
+    json_value(number_big_integer_t&& num)
+    {
+        set_big_integer(create<number_big_integer_t>(std::move(num)));
     }
 
     json_value(const number_float_t num)
     {
-        m_type = value_t::number_float;
-        m_data.number_float = num;
+        set_float(num);
     }
 
     json_value(const boolean_t val)
     {
-        m_type = value_t::boolean;
-        m_data.boolean = val;
+        set_boolean(val);
     }
 
     json_value(const value_t value_type)
     {
-        m_type = value_type;
         switch (value_type)
         {
             case value_t::null:
-                m_data.object = nullptr;
+                set_null();
                 break;
 
             case value_t::object:
-                m_data.object = create<object_t>();
+                set_object(create<object_t>());
                 break;
 
             case value_t::array:
-                m_data.array = create<array_t>();
+                set_array(create<array_t>());
                 break;
 
             case value_t::string:
-                m_data.string = create<string_t>();
+                set_string(create<string_t>());
                 break;
 
             case value_t::number_integer:
-                m_data.number_integer = number_integer_t(0);
+                set_integer(number_integer_t(0));
                 break;
 
             case value_t::number_float:
-                m_data.number_float = number_float_t(0.0);
+                set_float(number_float_t(0.0));
                 break;
 
             case value_t::boolean:
-                m_data.boolean = boolean_t(false);
+                set_boolean(boolean_t(false));
+                break;
+
+            case value_t::number_unsigned:
+                set_unsigned(number_unsigned_t(0));
+                break;
+
+            case value_t::number_big_integer:
+                set_big_integer(create<number_big_integer_t>());
                 break;
         }
     }
@@ -150,47 +281,58 @@ public:
 
     json_value(const json_value& other)
     {
-        m_type = other.m_type;
-        switch (other.m_type)
+        switch (other.type())
         {
             case value_t::null:
-                m_data.object = nullptr;
+                set_null();
                 break;
 
             case value_t::object:
-                m_data.object = create<object_t>(*other.m_data.object);
+                set_object(share(other.object_ptr()));
                 break;
 
             case value_t::array:
-                m_data.array = create<array_t>(*other.m_data.array);
+                if (other.is_packed())
+                {
+                    set_packed(share(other.packed_ptr()));
+                }
+                else
+                {
+                    set_array(share(other.array_ptr()));
+                }
                 break;
 
             case value_t::string:
-                m_data.string = create<string_t>(*other.m_data.string);
+                set_string(share(other.string_ptr()));
                 break;
 
             case value_t::number_integer:
-                m_data.number_integer = other.m_data.number_integer;
+                copy_integer(other);
                 break;
 
             case value_t::number_float:
-                m_data.number_float = other.m_data.number_float;
+                set_float(other.float_value());
                 break;
 
             case value_t::boolean:
-                m_data.boolean = other.m_data.boolean;
+                set_boolean(other.boolean_value());
+                break;
+
+            case value_t::number_unsigned:
+                copy_unsigned(other);
+                break;
+
+            case value_t::number_big_integer:
+                set_big_integer(share(other.big_integer_ptr()));
                 break;
         }
     }
-    
+
     json_value(json_value&& other)noexcept
     {
-        m_type = other.m_type;
-        m_data = other.m_data;
-        other.m_type = value_t::null;
-        other.m_data.object = nullptr;
+        steal(other);
     }
-    
+
     json_value& operator=(const json_value& other)
     {
         if (this != &other)
@@ -219,118 +361,600 @@ public:
 
 
 public:
-    void swap(json_value& other)noexcept
+    void clear()
     {
-        std::swap(m_type, other.m_type);
-        std::swap(m_data, other.m_data);
+        switch (type())
+        {
+            case value_t::object:
+            case value_t::array:
+                destroy_tree();
+                break;
+
+            case value_t::string:
+                release(string_ptr());
+                break;
+
+            case value_t::number_integer:
+                destroy_integer();
+                break;
+
+            case value_t::number_unsigned:
+                destroy_unsigned();
+                break;
+
+            case value_t::number_big_integer:
+                release(big_integer_ptr());
+                break;
+
+            default:
+                break;
+        }
+
+        set_null();
     }
 
-    void clear()
+    // destroy a container without recursing into nested containers and
+    // without allocating, so the stack depth does not depend on the depth of
+    // the document and a destructor cannot run out of memory. containers
+    // still to be torn down form a list linked through their own storage:
+    // one element of each is moved out and replaced by the rest of the list
+    void destroy_tree()noexcept
+    {
+        json_value pending;
+        push_pending(pending, std::move(*this));
+
+        while (pending.type() != value_t::null)
+        {
+            json_value current(std::move(pending));
+            json_value& link = current.link_slot();
+            pending = std::move(link);
+
+            if (current.type() == value_t::object)
+            {
+                for (auto& member : current.object_ptr()->value)
+                {
+                    if (member.second.is_object() || member.second.is_array())
+                    {
+                        push_pending(pending, std::move(member.second.m_value));
+                    }
+                }
+            }
+            else
+            {
+                for (auto& element : current.array_ptr()->value)
+                {
+                    if (element.is_object() || element.is_array())
+                    {
+                        push_pending(pending, std::move(element.m_value));
+                    }
+                }
+            }
+            // only scalars are left in it
+            current.release_container();
+        }
+    }
+
+    // puts value onto the list if it holds nested values, releases it otherwise.
+    // its linking element may be a container itself, which follows it on
+    static void push_pending(json_value& pending, json_value&& value)noexcept
+    {
+        json_value item(std::move(value));
+        while (item.has_nested())
+        {
+            json_value& link = item.link_slot();
+            json_value next(std::move(link));
+            link = std::move(pending);
+            pending = std::move(item);
+            item = std::move(next);
+        }
+
+        if (item.type() == value_t::object || item.type() == value_t::array)
+        {
+            item.release_container();
+        }
+    }
+
+    // an object or an unpacked array with elements, not shared with anyone
+    bool has_nested()const noexcept
     {
-        switch (m_type)
+        switch (type())
         {
             case value_t::object:
-                delete m_data.object;
-                m_data.object = nullptr;
+                return last_owner(object_ptr()) && !object_ptr()->value.empty();
 
             case value_t::array:
-                delete m_data.array;
-                m_data.array = nullptr;
+                return !is_packed() && last_owner(array_ptr()) && !array_ptr()->value.empty();
+
+            default:
+                return false;
+        }
+    }
+
+    // has_nested(), the element that links it into the list of destroy_tree()
+    json_value& link_slot()noexcept
+    {
+        if (type() == value_t::object)
+        {
+            return object_ptr()->value.begin()->second.m_value;
+        }
+        return array_ptr()->value.back().m_value;
+    }
+
+    // release the node of an object or array, whatever it holds is destroyed with it
+    void release_container()noexcept
+    {
+        switch (type())
+        {
+            case value_t::object:
+                release(object_ptr());
                 break;
 
-            case value_t::string:
-                delete m_data.string;
-                m_data.string = nullptr;
+            case value_t::array:
+                if (is_packed())
+                {
+                    release(packed_ptr());
+                }
+                else
+                {
+                    release(array_ptr());
+                }
                 break;
-            
+
             default:
-                m_data.object = nullptr;
-                break;
+                return;
         }
 
-        m_type = value_t::null;
+        set_null();
+    }
+
+    template<typename Ty>
+    static bool last_owner(const json_node<Ty>* node)noexcept
+    {
+#if defined(SJSON_COPY_ON_WRITE)
+        return node->ref_count.load(std::memory_order_acquire) == 1;
+#else
+        (void)node;
+        return true;
+#endif
     }
 
+    // nodes are allocated through the allocator policy of BasicJsonType.
+    // a node the value cannot address is freed before anything refers to it
     template<typename Ty, typename... Args>
-    static Ty* create(Args&&... args)
+    static json_node<Ty>* create(Args&&... args)
+    {
+        node_allocator<Ty> alloc;
+        auto node = node_traits<Ty>::allocate(alloc, 1);
+        if (!addressable(node))
+        {
+            node_traits<Ty>::deallocate(alloc, node, 1);
+            throw json_exception("pointer does not fit in a compact json value");
+        }
+
+        try
+        {
+            node_traits<Ty>::construct(alloc, node, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            node_traits<Ty>::deallocate(alloc, node, 1);
+            throw;
+        }
+        json_allocation_stats::record_allocate(node_size<Ty>());
+        return node;
+    }
+
+    template<typename Ty>
+    static void destroy(json_node<Ty>* node)noexcept
+    {
+        node_allocator<Ty> alloc;
+        node_traits<Ty>::destroy(alloc, node);
+        node_traits<Ty>::deallocate(alloc, node, 1);
+        json_allocation_stats::record_deallocate(node_size<Ty>());
+    }
+
+    // the bytes of a node as handed out by the allocator policy
+    template<typename Ty>
+    static std::size_t node_size()noexcept
+    {
+        return allocation_size<node_allocator<Ty>>(sizeof(json_node<Ty>));
+    }
+
+    // a node for a new owner of the value
+    template<typename Ty>
+    static json_node<Ty>* share(json_node<Ty>* node)
+    {
+#if defined(SJSON_COPY_ON_WRITE)
+        if (!node->pinned)
+        {
+            node->ref_count.fetch_add(1, std::memory_order_relaxed);
+            return node;
+        }
+#endif
+        return create<Ty>(node->value);
+    }
+
+    template<typename Ty>
+    static void release(json_node<Ty>* node)noexcept
+    {
+#if defined(SJSON_COPY_ON_WRITE)
+        if (node->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+#endif
+        destroy(node);
+    }
+
+    // a node owned only by the caller, cloning it if it is shared
+    template<typename Ty>
+    static json_node<Ty>* unshare(json_node<Ty>* node, const bool pin)
+    {
+#if defined(SJSON_COPY_ON_WRITE)
+        if (node->ref_count.load(std::memory_order_acquire) != 1)
+        {
+            auto copy = create<Ty>(node->value);
+            release(node);
+            node = copy;
+        }
+#endif
+
+#if defined(SJSON_COPY_ON_WRITE) || defined(SJSON_HASH_CACHE)
+        node->pinned = node->pinned || pin;
+#else
+        (void)pin;
+#endif
+
+#if defined(SJSON_HASH_CACHE)
+        node->hash.store(0, std::memory_order_relaxed);
+#endif
+        return node;
+    }
+
+
+public:
+    // unchecked accessors, the caller must check type() first.
+    // the non-const ones detach a shared container, and pin it because
+    // the caller may keep references into it
+    object_t&       object_value()      { return modify_object(true);   }
+    array_t&        array_value()       { return modify_array(true);    }
+    string_t&       string_value()      { return modify_string(true);   }
+
+    const object_t& object_value()const { return object_ptr()->value;   }
+    const array_t&  array_value()const
+    {
+        // a packed array is not changed, it builds a general view of itself
+        return is_packed() ? packed_value().array_view() : array_ptr()->value;
+    }
+    const string_t& string_value()const { return string_ptr()->value;   }
+
+    const number_big_integer_t& big_integer_value()const { return big_integer_ptr()->value; }
+
+    // detach a shared container for a change that keeps no reference into it
+    object_t& modify_object(const bool pin = false)
+    {
+        set_object(unshare(object_ptr(), pin));
+        return object_ptr()->value;
+    }
+
+    array_t& modify_array(const bool pin = false)
+    {
+        unpack();
+        set_array(unshare(array_ptr(), pin));
+        return array_ptr()->value;
+    }
+
+    string_t& modify_string(const bool pin = false)
+    {
+        set_string(unshare(string_ptr(), pin));
+        return string_ptr()->value;
+    }
+
+
+public:
+    bool is_packed()const noexcept
+    {
+#if defined(SJSON_PACKED_ARRAYS)
+        return packed_tagged();
+#else
+        return false;
+#endif
+    }
+
+    const packed_t& packed_value()const { return packed_ptr()->value; }
+
+    packed_t& modify_packed()
+    {
+        set_packed(unshare(packed_ptr(), false));
+        return packed_ptr()->value;
+    }
+
+    // turn a packed array into a general one
+    void unpack()
+    {
+        if (!is_packed())
+        {
+            return;
+        }
+
+        const auto packed = packed_ptr();
+        const auto node = create<array_t>();
+        try
+        {
+            packed->value.unpack_to(node->value);
+        }
+        catch (...)
+        {
+            destroy(node);
+            throw;
+        }
+        release(packed);
+        set_array(node);
+    }
+
+    // append to a packed array, an empty array is packed first.
+    // false if the array stays general, the caller appends the value then
+    bool push_packed(const number_integer_t num)    { return push_packed(value_t::number_integer, num); }
+    bool push_packed(const number_float_t num)      { return push_packed(value_t::number_float, num);   }
+    bool push_packed(const boolean_t val)           { return push_packed(value_t::boolean, val);        }
+
+    bool push_packed(const json_value& val)
+    {
+        switch (val.type())
+        {
+            case value_t::number_integer:   return push_packed(val.integer_value());
+            case value_t::number_float:     return push_packed(val.float_value());
+            case value_t::boolean:          return push_packed(val.boolean_value());
+            default:                        return false;
+        }
+    }
+
+    template<typename Ty>
+    bool push_packed(const Ty&)
+    {
+        return false;
+    }
+
+private:
+    template<typename Ty>
+    bool push_packed(const value_t element_type, const Ty val)
+    {
+#if defined(SJSON_PACKED_ARRAYS)
+        if (!is_packed())
+        {
+            if (!array_ptr()->value.empty())
+            {
+                return false;
+            }
+
+            // keep what was reserved for the general array
+            const auto node = create<packed_t>(element_type);
+            try
+            {
+                node->value.reserve(array_ptr()->value.capacity());
+            }
+            catch (...)
+            {
+                destroy(node);
+                throw;
+            }
+            release(array_ptr());
+            set_packed(node);
+        }
+
+        return modify_packed().push_back(val);
+#else
+        (void)element_type;
+        (void)val;
+        return false;
+#endif
+    }
+
+    static bool is_number(const value_t type)noexcept
+    {
+        return type == value_t::number_integer || type == value_t::number_unsigned ||
+            type == value_t::number_big_integer || type == value_t::number_float;
+    }
+
+public:
+    // any number as a float, a big integer is rounded to the nearest
+    number_float_t to_float()const
+    {
+        switch (type())
+        {
+            case value_t::number_integer:       return static_cast<number_float_t>(integer_value());
+            case value_t::number_unsigned:      return static_cast<number_float_t>(unsigned_value());
+            case value_t::number_big_integer:   return big_integer_value().template to_float<number_float_t>();
+            default:                            return float_value();
+        }
+    }
+
+    // any integer as a big integer
+    number_big_integer_t to_big_integer()const
+    {
+        switch (type())
+        {
+            case value_t::number_integer:       return number_big_integer_t(integer_value());
+            case value_t::number_unsigned:      return number_big_integer_t(unsigned_value());
+            default:                            return big_integer_value();
+        }
+    }
+
+private:
+    // an array with a packed side, compared element by element
+    static bool equal_packed(const json_value& lhs, const json_value& rhs)
+    {
+        if (lhs.is_packed() && rhs.is_packed() &&
+            lhs.packed_value().element_type() == rhs.packed_value().element_type())
+        {
+            return lhs.packed_ptr() == rhs.packed_ptr() || lhs.packed_value() == rhs.packed_value();
+        }
+
+        const auto size = lhs.array_size();
+        if (size != rhs.array_size())
+        {
+            return false;
+        }
+
+        json_value lhs_element;
+        json_value rhs_element;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (lhs.element_at(i, lhs_element) != rhs.element_at(i, rhs_element))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    std::size_t array_size()const noexcept
+    {
+        return is_packed() ? packed_value().size() : array_ptr()->value.size();
+    }
+
+    // element index of an array by reference, a packed one builds a view of
+    // the elements around it, see json_packed_array
+    const BasicJsonType& element(const std::size_t index)const
+    {
+        return is_packed() ? packed_value().element(index) : array_ptr()->value[index];
+    }
+
+    // element index of an array, a packed element is copied into buffer
+    const json_value& element_at(const std::size_t index, json_value& buffer)const
     {
-        return new Ty(std::forward<Args>(args)...);
+        if (!is_packed())
+        {
+            return array_ptr()->value[index].m_value;
+        }
+
+        const auto& packed = packed_value();
+        switch (packed.element_type())
+        {
+            case value_t::number_integer:
+                buffer = json_value(static_cast<number_integer_t>(packed.template elements<number_integer_t>()[index]));
+                break;
+
+            case value_t::number_float:
+                buffer = json_value(static_cast<number_float_t>(packed.template elements<number_float_t>()[index]));
+                break;
+
+            default:
+                buffer = json_value(static_cast<boolean_t>(packed.template elements<boolean_t>()[index]));
+                break;
+        }
+        return buffer;
     }
 
 
 public:
     void get(std::nullptr_t& null)const
     {
-        if (m_type != value_t::null)
+        if (type() != value_t::null)
         {
             throw json_type_error("json value type must be a null");
         }
-        
+
         null = nullptr;
     }
 
     void get(object_t& obj)const
     {
-        if (m_type != value_t::object)
+        if (type() != value_t::object)
         {
             throw json_type_error("json value type must be a object");
         }
 
-        obj = *m_data.object;
+        obj = object_value();
     }
 
     void get(array_t& arr)const
     {
-        if (m_type != value_t::array)
+        if (type() != value_t::array)
         {
             throw json_type_error("json value type must be a array");
         }
 
-        arr = *m_data.array;
+        if (is_packed())
+        {
+            arr.clear();
+            packed_value().unpack_to(arr);
+        }
+        else
+        {
+            arr = array_value();
+        }
     }
 
     void get(string_t& str)const
     {
-        if (m_type != value_t::string)
+        if (type() != value_t::string)
         {
             throw json_type_error("json value type must be a string");
         }
 
-        str = *m_data.string;
+        str = string_value();
     }
 
     template<typename Integer,
             typename std::enable_if<std::is_integral<Integer>::value, int>::type = 0>
     void get(Integer& num)const
     {
-        if (m_type != value_t::number_integer)
+        switch (type())
         {
-            throw json_type_error("json value type must be an integer");
+            case value_t::number_integer:
+                num = static_cast<Integer>(integer_value());
+                break;
+
+            case value_t::number_unsigned:
+                if (unsigned_value() > static_cast<number_unsigned_t>(std::numeric_limits<Integer>::max()))
+                {
+                    throw json_type_error("json unsigned integer does not fit in the integer type");
+                }
+                num = static_cast<Integer>(unsigned_value());
+                break;
+
+            default:
+                throw json_type_error("json value type must be an integer");
         }
+    }
+
+    void get(number_big_integer_t& num)const
+    {
+        switch (type())
+        {
+            case value_t::number_integer:
+            case value_t::number_unsigned:
+            case value_t::number_big_integer:
+                num = to_big_integer();
+                break;
 
-        num = m_data.number_integer;
+            default:
+                throw json_type_error("json value type must be an integer");
+        }
     }
 
     template<typename Floating,
             typename std::enable_if<std::is_floating_point<Floating>::value, int>::type = 0>
     void get(Floating& num)const
     {
-        if (m_type != value_t::number_float)
+        if (type() != value_t::number_float)
         {
             throw json_type_error("json value type must be a float");
         }
 
-        num = m_data.number_float;
+        num = float_value();
     }
 
     void get(boolean_t& val)const
     {
-        if (m_type != value_t::boolean)
+        if (type() != value_t::boolean)
         {
             throw json_type_error("json value type must be a boolean");
         }
 
-        val = m_data.boolean;
+        val = boolean_value();
     }
 
     [[noreturn]] void get(...)const
@@ -340,47 +964,117 @@ public:
 
 
 public:
-    friend bool operator==(const json_value& lhs, const json_value& rhs)
+    // move a container out, the value is left empty and should be cleared
+    void take(object_t& obj)
     {
-        if (lhs.m_type == rhs.m_type)
+        if (type() != value_t::object)
         {
-            switch (lhs.m_type)
-            {
-                case value_t::null:
+            throw json_type_error("json value type must be a object");
+        }
+
+        move_out(object_ptr(), obj);
+    }
+
+    void take(array_t& arr)
+    {
+        if (type() != value_t::array)
+        {
+            throw json_type_error("json value type must be a array");
+        }
+
+        if (is_packed())
+        {
+            get(arr);
+            return;
+        }
+
+        move_out(array_ptr(), arr);
+    }
+
+    void take(string_t& str)
+    {
+        if (type() != value_t::string)
+        {
+            throw json_type_error("json value type must be a string");
+        }
+
+        move_out(string_ptr(), str);
+    }
+
+    template<typename Ty>
+    void take(Ty& val)
+    {
+        get(val);
+    }
+
+private:
+    // a shared node is copied, the other owners still see it
+    template<typename Ty>
+    static void move_out(json_node<Ty>* node, Ty& val)
+    {
+        if (last_owner(node))
+        {
+            val = std::move(node->value);
+        }
+        else
+        {
+            val = node->value;
+        }
+    }
+
+
+public:
+    friend bool operator==(const json_value& lhs, const json_value& rhs)
+    {
+        const value_t lhs_type = lhs.type();
+        const value_t rhs_type = rhs.type();
+        if (lhs_type == rhs_type)
+        {
+            switch (lhs_type)
+            {
+                case value_t::null:
                     return true;
 
                 case value_t::object:
-                    return *lhs.m_data.object == *rhs.m_data.object;
-    
+                    return lhs.object_ptr() == rhs.object_ptr() || lhs.object_value() == rhs.object_value();
+
                 case value_t::array:
-                    return *lhs.m_data.array == *rhs.m_data.array;
-    
+                    if (lhs.is_packed() || rhs.is_packed())
+                    {
+                        return equal_packed(lhs, rhs);
+                    }
+                    return lhs.array_ptr() == rhs.array_ptr() || lhs.array_value() == rhs.array_value();
+
                 case value_t::string:
-                    return *lhs.m_data.string == *rhs.m_data.string;
-    
+                    return lhs.string_ptr() == rhs.string_ptr() || lhs.string_value() == rhs.string_value();
+
                 case value_t::number_integer:
-                    return lhs.m_data.number_integer == rhs.m_data.number_integer;
-    
+                    return lhs.integer_value() == rhs.integer_value();
+
                 case value_t::number_float:
-                    return lhs.m_data.number_float == rhs.m_data.number_float;
-    
+                    // NaN equals NaN, as in compare()
+                    return compare_floats(lhs.float_value(), rhs.float_value()) == 0;
+
                 case value_t::boolean:
-                    return lhs.m_data.boolean == rhs.m_data.boolean;
-    
+                    return lhs.boolean_value() == rhs.boolean_value();
+
+                case value_t::number_unsigned:
+                    return lhs.unsigned_value() == rhs.unsigned_value();
+
+                case value_t::number_big_integer:
+                    return lhs.big_integer_ptr() == rhs.big_integer_ptr() || lhs.big_integer_value() == rhs.big_integer_value();
+
                 default:
                     return false;
             }
         }
-        else if ((lhs.m_type == value_t::number_integer) && (rhs.m_type == value_t::number_float))
-        {
-            return static_cast<number_float_t>(lhs.m_data.number_integer) == rhs.m_data.number_float;
-        }
-        else if ((lhs.m_type == value_t::number_float) && (rhs.m_type == value_t::number_integer))
+        else if (is_number(lhs_type) && is_number(rhs_type))
         {
-            return static_cast<number_float_t>(rhs.m_data.number_integer) == lhs.m_data.number_float;
+            return compare_numbers(lhs, rhs) == 0;
         }
-    
-        throw json_type_error("cannot compare two different types of json");
+
+        // values of different types are never equal
+        return false;
     }
 
     friend bool operator!=(const json_value& lhs, const json_value& rhs)
@@ -388,19 +1082,850 @@ public:
         return !(lhs == rhs);
     }
 
+    friend bool operator<(const json_value& lhs, const json_value& rhs)
+    {
+        return compare(lhs, rhs) < 0;
+    }
+
+    // a total order of all values, negative, zero or positive like strcmp:
+    // null < boolean < number < string < array < object. numbers of every
+    // kind compare by value, exactly between integers and floats, with NaN
+    // after every other number and equal to itself, so compare() is zero
+    // exactly when operator== holds. arrays and objects compare
+    // lexicographically, the members of an object in key order
+    static int compare(const json_value& lhs, const json_value& rhs)
+    {
+        const value_t lhs_type = lhs.type();
+        const value_t rhs_type = rhs.type();
+        if (is_number(lhs_type) && is_number(rhs_type))
+        {
+            return compare_numbers(lhs, rhs);
+        }
+
+        if (lhs_type != rhs_type)
+        {
+            return type_rank(lhs_type) < type_rank(rhs_type) ? -1 : 1;
+        }
+
+        switch (lhs_type)
+        {
+            case value_t::object:
+                return lhs.object_ptr() == rhs.object_ptr() ? 0 : compare_objects(lhs.object_value(), rhs.object_value());
+
+            case value_t::array:
+                return compare_arrays(lhs, rhs);
+
+            case value_t::string:
+                return lhs.string_ptr() == rhs.string_ptr() ? 0 : sign(lhs.string_value().compare(rhs.string_value()));
+
+            case value_t::boolean:
+                return static_cast<int>(lhs.boolean_value()) - static_cast<int>(rhs.boolean_value());
+
+            default:
+                return 0;
+        }
+    }
+
+private:
+    static int type_rank(const value_t type)noexcept
+    {
+        switch (type)
+        {
+            case value_t::null:     return 0;
+            case value_t::boolean:  return 1;
+            case value_t::string:   return 3;
+            case value_t::array:    return 4;
+            case value_t::object:   return 5;
+            default:                return 2;
+        }
+    }
+
+    template<typename Ty>
+    static int sign(const Ty val)noexcept
+    {
+        return (Ty(0) < val) - (val < Ty(0));
+    }
+
+    static int compare_objects(const object_t& lhs, const object_t& rhs)
+    {
+        auto lhs_iter = lhs.begin();
+        auto rhs_iter = rhs.begin();
+        for (; lhs_iter != lhs.end() && rhs_iter != rhs.end(); ++lhs_iter, ++rhs_iter)
+        {
+            const auto& lhs_key = static_cast<const string_t&>(lhs_iter->first);
+            const auto& rhs_key = static_cast<const string_t&>(rhs_iter->first);
+            int result = &lhs_key == &rhs_key ? 0 : sign(lhs_key.compare(rhs_key));
+            if (result == 0)
+            {
+                result = compare(lhs_iter->second.m_value, rhs_iter->second.m_value);
+            }
+            if (result != 0)
+            {
+                return result;
+            }
+        }
+
+        return sign(static_cast<long long>(lhs.size()) - static_cast<long long>(rhs.size()));
+    }
+
+    static int compare_arrays(const json_value& lhs, const json_value& rhs)
+    {
+        if (lhs.is_packed() && rhs.is_packed() &&
+            lhs.packed_value().element_type() == value_t::number_integer &&
+            rhs.packed_value().element_type() == value_t::number_integer)
+        {
+            // plain integers, skip the common prefix in one pass
+            const auto& lhs_vec = lhs.packed_value().template elements<number_integer_t>();
+            const auto& rhs_vec = rhs.packed_value().template elements<number_integer_t>();
+            const bool shorter = lhs_vec.size() < rhs_vec.size();
+            const auto diff = shorter ? std::mismatch(lhs_vec.begin(), lhs_vec.end(), rhs_vec.begin())
+                : std::mismatch(rhs_vec.begin(), rhs_vec.end(), lhs_vec.begin());
+            const auto lhs_iter = shorter ? diff.first : diff.second;
+            const auto rhs_iter = shorter ? diff.second : diff.first;
+            if (lhs_iter != lhs_vec.end() && rhs_iter != rhs_vec.end())
+            {
+                return *lhs_iter < *rhs_iter ? -1 : 1;
+            }
+            return sign(static_cast<long long>(lhs_vec.size()) - static_cast<long long>(rhs_vec.size()));
+        }
+
+        if (!lhs.is_packed() && !rhs.is_packed() && lhs.array_ptr() == rhs.array_ptr())
+        {
+            return 0;
+        }
+
+        const auto lhs_size = lhs.array_size();
+        const auto rhs_size = rhs.array_size();
+        json_value lhs_element;
+        json_value rhs_element;
+        for (std::size_t i = 0; i < lhs_size && i < rhs_size; ++i)
+        {
+            const int result = compare(lhs.element_at(i, lhs_element), rhs.element_at(i, rhs_element));
+            if (result != 0)
+            {
+                return result;
+            }
+        }
+
+        return sign(static_cast<long long>(lhs_size) - static_cast<long long>(rhs_size));
+    }
+
+    // two numbers of any kinds
+    static int compare_numbers(const json_value& lhs, const json_value& rhs)
+    {
+        const value_t lhs_type = lhs.type();
+        const value_t rhs_type = rhs.type();
+        if (lhs_type == value_t::number_float)
+        {
+            return rhs_type == value_t::number_float ?
+                compare_floats(lhs.float_value(), rhs.float_value()) : -compare_with_float(rhs, lhs.float_value());
+        }
+
+        if (rhs_type == value_t::number_float)
+        {
+            return compare_with_float(lhs, rhs.float_value());
+        }
+
+        if (lhs_type == value_t::number_big_integer || rhs_type == value_t::number_big_integer)
+        {
+            const auto lhs_num = lhs.to_big_integer();
+            const auto rhs_num = rhs.to_big_integer();
+            return lhs_num < rhs_num ? -1 : (rhs_num < lhs_num ? 1 : 0);
+        }
+
+        if (lhs_type == rhs_type)
+        {
+            return lhs_type == value_t::number_integer ?
+                compare_values(lhs.integer_value(), rhs.integer_value()) : compare_values(lhs.unsigned_value(), rhs.unsigned_value());
+        }
+
+        // an integer and an unsigned
+        if (lhs_type == value_t::number_integer)
+        {
+            return lhs.integer_value() < 0 ? -1 : compare_values(static_cast<number_unsigned_t>(lhs.integer_value()), rhs.unsigned_value());
+        }
+        return rhs.integer_value() < 0 ? 1 : compare_values(lhs.unsigned_value(), static_cast<number_unsigned_t>(rhs.integer_value()));
+    }
+
+    template<typename Ty>
+    static int compare_values(const Ty lhs, const Ty rhs)noexcept
+    {
+        return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+    }
+
+    static int compare_floats(const number_float_t lhs, const number_float_t rhs)noexcept
+    {
+        if (lhs < rhs || rhs < lhs || lhs == rhs)
+        {
+            return compare_values(lhs, rhs);
+        }
+
+        // a NaN is after every other number
+        return static_cast<int>(lhs != lhs) - static_cast<int>(rhs != rhs);
+    }
+
+    // an integer of any kind and a float
+    static int compare_with_float(const json_value& num, const number_float_t val)
+    {
+        switch (num.type())
+        {
+            case value_t::number_integer:   return compare_integral(num.integer_value(), val);
+            case value_t::number_unsigned:  return compare_integral(num.unsigned_value(), val);
+            default:                        return num.big_integer_value().compare(val);
+        }
+    }
+
+    // exact, the integer is not rounded to a float
+    template<typename Integer>
+    static int compare_integral(const Integer num, const number_float_t val)noexcept
+    {
+        // both bounds are powers of two, exact as floats
+        const number_float_t lowest = static_cast<number_float_t>(std::numeric_limits<Integer>::min());
+        const number_float_t bound = static_cast<number_float_t>(std::numeric_limits<Integer>::max()) + 1;
+        if (val != val || val >= bound)
+        {
+            return -1;
+        }
+        if (val < lowest)
+        {
+            return 1;
+        }
+
+        const auto whole = static_cast<Integer>(val);
+        if (num != whole)
+        {
+            return num < whole ? -1 : 1;
+        }
+
+        const number_float_t fraction = val - static_cast<number_float_t>(whole);
+        return fraction > 0 ? -1 : (fraction < 0 ? 1 : 0);
+    }
+
+
+public:
+    // a hash of the structure and the values, consistent with operator==:
+    // every number is hashed as a float, members are hashed independently
+    // of their order and a packed array hashes like the general one
+    std::size_t hash()const
+    {
+        switch (type())
+        {
+            case value_t::null:
+                return hash_mix(static_cast<std::size_t>(value_t::null));
+
+            case value_t::object:
+                return cached_hash(object_ptr());
+
+            case value_t::array:
+                return is_packed() ? hash_packed(packed_value()) : cached_hash(array_ptr());
+
+            case value_t::string:
+                return hash_combine(static_cast<std::size_t>(value_t::string), std::hash<string_t>()(string_value()));
+
+            case value_t::boolean:
+                return hash_boolean(boolean_value());
+
+            default:
+                return hash_number(to_float());
+        }
+    }
+
+private:
+    template<typename Ty>
+    static std::size_t cached_hash(json_node<Ty>* node)
+    {
+#if defined(SJSON_HASH_CACHE)
+        if (!node->pinned)
+        {
+            auto hash = node->hash.load(std::memory_order_relaxed);
+            if (hash == 0)
+            {
+                hash = hash_value(node->value);
+                hash = hash != 0 ? hash : 1;
+                node->hash.store(hash, std::memory_order_relaxed);
+            }
+            return hash;
+        }
+#endif
+        return hash_value(node->value);
+    }
+
+    static std::size_t hash_value(const object_t& obj)
+    {
+        // a sum of the members does not depend on their order
+        std::size_t hash = hash_mix(static_cast<std::size_t>(value_t::object));
+        for (const auto& member : obj)
+        {
+            const auto key = std::hash<string_t>()(static_cast<const string_t&>(member.first));
+            hash += hash_mix(hash_combine(key, member.second.hash()));
+        }
+        return hash;
+    }
+
+    static std::size_t hash_value(const array_t& arr)
+    {
+        std::size_t hash = hash_mix(static_cast<std::size_t>(value_t::array));
+        for (const auto& element : arr)
+        {
+            hash = hash_combine(hash, element.hash());
+        }
+        return hash;
+    }
+
+    static std::size_t hash_packed(const packed_t& packed)
+    {
+        std::size_t hash = hash_mix(static_cast<std::size_t>(value_t::array));
+        switch (packed.element_type())
+        {
+            case value_t::number_integer:
+                for (const auto num : packed.template elements<number_integer_t>())
+                {
+                    hash = hash_combine(hash, hash_number(static_cast<number_float_t>(num)));
+                }
+                break;
+
+            case value_t::number_float:
+                for (const auto num : packed.template elements<number_float_t>())
+                {
+                    hash = hash_combine(hash, hash_number(num));
+                }
+                break;
+
+            case value_t::boolean:
+                for (const bool val : packed.template elements<boolean_t>())
+                {
+                    hash = hash_combine(hash, hash_boolean(val));
+                }
+                break;
+
+            default:
+                break;
+        }
+        return hash;
+    }
+
+    static std::size_t hash_number(number_float_t num)
+    {
+        // 0.0 == -0.0, and every NaN equals every other
+        num = num == 0 ? number_float_t(0) : (num != num ? std::numeric_limits<number_float_t>::quiet_NaN() : num);
+        return hash_combine(static_cast<std::size_t>(value_t::number_float), std::hash<number_float_t>()(num));
+    }
+
+    static std::size_t hash_boolean(const bool val)noexcept
+    {
+        return hash_mix(static_cast<std::size_t>(value_t::boolean) * 2 + (val ? 1 : 0));
+    }
+
+    static std::size_t hash_combine(const std::size_t seed, const std::size_t hash)noexcept
+    {
+        return hash_mix(seed ^ (hash + static_cast<std::size_t>(0x9e3779b97f4a7c15ull) + (seed << 6) + (seed >> 2)));
+    }
+
+    // the 64-bit finalizer of murmur3, spreads every input bit
+    static std::size_t hash_mix(std::size_t hash)noexcept
+    {
+        std::uint64_t val = hash;
+        val ^= val >> 33;
+        val *= 0xff51afd7ed558ccdull;
+        val ^= val >> 33;
+        val *= 0xc4ceb9fe1a85ec53ull;
+        val ^= val >> 33;
+        return static_cast<std::size_t>(val);
+    }
+
+
+public:
+    // the heap bytes held by the value and everything below it. under
+    // SJSON_COPY_ON_WRITE a node reached twice is counted once, though it
+    // may also be held by another document
+    json_memory_usage memory_usage()const
+    {
+        json_memory_usage usage;
+        std::unordered_set<const void*> seen;
+        std::vector<const json_value*> stack(1, this);
+        while (!stack.empty())
+        {
+            const auto current = stack.back();
+            stack.pop_back();
+            current->add_memory_usage(usage, seen, stack);
+        }
+        return usage;
+    }
+
+private:
+    void add_memory_usage(json_memory_usage& usage, std::unordered_set<const void*>& seen,
+                          std::vector<const json_value*>& stack)const
+    {
+        switch (type())
+        {
+            case value_t::object:
+            {
+                ++usage.objects;
+                if (!first_visit(object_ptr(), seen))
+                {
+                    return;
+                }
+
+                const auto& object = object_value();
+                usage.nodes += node_size<object_t>();
+                add_object_storage(usage, object, has_capacity<object_t>());
+                for (const auto& member : object)
+                {
+                    usage.keys += key_heap_size(member.first);
+                    stack.push_back(&member.second.m_value);
+                }
+                return;
+            }
+
+            case value_t::array:
+            {
+                ++usage.arrays;
+                if (is_packed())
+                {
+                    if (first_visit(packed_ptr(), seen))
+                    {
+                        usage.nodes += node_size<packed_t>();
+                        add_packed_storage(usage, packed_value());
+                        usage.slack += packed_value().view_size();
+                    }
+                    return;
+                }
+
+                if (!first_visit(array_ptr(), seen))
+                {
+                    return;
+                }
+
+                const auto& array = array_ptr()->value;
+                usage.nodes += node_size<array_t>();
+                usage.elements += array.size() * sizeof(typename array_t::value_type);
+                usage.slack += (capacity_of(array) - array.size()) * sizeof(typename array_t::value_type);
+                for (const auto& element : array)
+                {
+                    stack.push_back(&element.m_value);
+                }
+                return;
+            }
+
+            case value_t::string:
+                ++usage.string_count;
+                if (first_visit(string_ptr(), seen))
+                {
+                    usage.nodes += node_size<string_t>();
+                    usage.strings += string_heap_size(string_value());
+                }
+                return;
+
+            case value_t::number_big_integer:
+                if (first_visit(big_integer_ptr(), seen))
+                {
+                    usage.nodes += node_size<number_big_integer_t>();
+                    usage.strings += string_heap_size(big_integer_value().str());
+                }
+                return;
+
+            case value_t::number_integer:
+                if (first_visit(boxed_number_ptr<number_integer_t>(), seen))
+                {
+                    usage.nodes += node_size<number_integer_t>();
+                }
+                return;
+
+            case value_t::number_unsigned:
+                if (first_visit(boxed_number_ptr<number_unsigned_t>(), seen))
+                {
+                    usage.nodes += node_size<number_unsigned_t>();
+                }
+                return;
+
+            default:
+                return;
+        }
+    }
+
+    // false if the node has been counted already, or if there is no node
+    template<typename Ty>
+    static bool first_visit(const json_node<Ty>* node, std::unordered_set<const void*>& seen)
+    {
+        if (node == nullptr)
+        {
+            return false;
+        }
+#if defined(SJSON_COPY_ON_WRITE)
+        if (node->ref_count.load(std::memory_order_relaxed) != 1)
+        {
+            return seen.insert(node).second;
+        }
+#else
+        (void)seen;
+#endif
+        return true;
+    }
+
+    static bool first_visit(std::nullptr_t, std::unordered_set<const void*>&)noexcept
+    {
+        return false;
+    }
+
+    // a node based object_t, an entry and a tree node header
+    static void add_object_storage(json_memory_usage& usage, const object_t& object, std::false_type)
+    {
+        usage.elements += object.size() * (sizeof(typename object_t::value_type) + 4 * sizeof(void*));
+    }
+
+    // a vector based object_t
+    static void add_object_storage(json_memory_usage& usage, const object_t& object, std::true_type)
+    {
+        usage.elements += object.size() * sizeof(typename object_t::value_type);
+        usage.slack += (object.capacity() - object.size()) * sizeof(typename object_t::value_type);
+    }
+
+    static void add_packed_storage(json_memory_usage& usage, const packed_t& packed)
+    {
+        std::size_t element_size = 0;
+        switch (packed.element_type())
+        {
+            case value_t::number_integer:   element_size = sizeof(number_integer_t);    break;
+            case value_t::number_float:     element_size = sizeof(number_float_t);      break;
+            default:
+                // std::vector<bool> keeps a bit per element
+                usage.elements += (packed.size() + 7) / 8;
+                usage.slack += (packed.capacity() - packed.size()) / 8;
+                return;
+        }
+        usage.elements += packed.size() * element_size;
+        usage.slack += (packed.capacity() - packed.size()) * element_size;
+    }
+
+    // the buffer of a string that does not fit in its inline storage
+    static std::size_t string_heap_size(const string_t& str)
+    {
+        static const std::size_t inline_capacity = string_t().capacity();
+        return str.capacity() > inline_capacity ? (str.capacity() + 1) * sizeof(char_type) : 0;
+    }
+
+    // an interned key is held by the atom table, not by the object
+    template<typename KeyType>
+    static std::size_t key_heap_size(const KeyType&)noexcept
+    {
+        return 0;
+    }
+
+    static std::size_t key_heap_size(const string_t& key)
+    {
+        return string_heap_size(key);
+    }
+
+
+#if !defined(SJSON_COMPACT_VALUE)
 
 public:
+    value_t type()const noexcept
+    {
+        return m_type;
+    }
+
+    number_integer_t  integer_value()const noexcept     { return m_data.number_integer;     }
+    number_unsigned_t unsigned_value()const noexcept    { return m_data.number_unsigned;    }
+    number_float_t    float_value()const noexcept       { return m_data.number_float;       }
+    boolean_t         boolean_value()const noexcept     { return m_data.boolean;            }
+
+    void swap(json_value& other)noexcept
+    {
+        std::swap(m_type, other.m_type);
+        std::swap(m_packed, other.m_packed);
+        std::swap(m_data, other.m_data);
+    }
+
+private:
+    json_node<object_t>*    object_ptr()const noexcept  { return m_data.object; }
+    json_node<array_t>*     array_ptr()const noexcept   { return m_data.array;  }
+    json_node<string_t>*    string_ptr()const noexcept  { return m_data.string; }
+    json_node<packed_t>*    packed_ptr()const noexcept  { return m_data.packed; }
+    json_node<number_big_integer_t>* big_integer_ptr()const noexcept { return m_data.big_integer; }
+
+    bool packed_tagged()const noexcept  { return m_type == value_t::array && m_packed; }
+
+    // numbers are never boxed in this layout
+    template<typename Ty>
+    std::nullptr_t boxed_number_ptr()const noexcept  { return nullptr; }
+
+    static bool addressable(const void*)noexcept    { return true; }
+
+    void set_null()noexcept                         { m_type = value_t::null;           m_data.object = nullptr;        }
+    void set_object(json_node<object_t>* obj)noexcept   { m_type = value_t::object; m_data.object = obj;    }
+    void set_array(json_node<array_t>* arr)noexcept     { m_type = value_t::array;  m_data.array = arr;     m_packed = false;   }
+    void set_packed(json_node<packed_t>* arr)noexcept   { m_type = value_t::array;  m_data.packed = arr;    m_packed = true;    }
+    void set_string(json_node<string_t>* str)noexcept   { m_type = value_t::string; m_data.string = str;    }
+    void set_integer(number_integer_t num)noexcept  { m_type = value_t::number_integer; m_data.number_integer = num;    }
+    void set_float(number_float_t num)noexcept      { m_type = value_t::number_float;   m_data.number_float = num;      }
+    void set_boolean(boolean_t val)noexcept         { m_type = value_t::boolean;        m_data.boolean = val;           }
+    void set_unsigned(number_unsigned_t num)noexcept    { m_type = value_t::number_unsigned;    m_data.number_unsigned = num;   }
+    void set_big_integer(json_node<number_big_integer_t>* num)noexcept { m_type = value_t::number_big_integer; m_data.big_integer = num; }
+
+    void copy_integer(const json_value& other)noexcept  { set_integer(other.integer_value()); }
+    void copy_unsigned(const json_value& other)noexcept { set_unsigned(other.unsigned_value()); }
+    void destroy_integer()noexcept { }
+    void destroy_unsigned()noexcept { }
+
+    void steal(json_value& other)noexcept
+    {
+        m_type = other.m_type;
+        m_packed = other.m_packed;
+        m_data = other.m_data;
+        other.set_null();
+    }
+
+private:
     value_t   m_type;
+    bool      m_packed = false;     // an array stored as json_packed_array
     union
     {
-        object_t*           object;
-        array_t*            array;
-        string_t*           string;
-        number_integer_t    number_integer;
-        number_float_t      number_float;
-        boolean_t           boolean;
+        json_node<object_t>*    object;
+        json_node<array_t>*     array;
+        json_node<string_t>*    string;
+        json_node<packed_t>*    packed;
+        json_node<number_big_integer_t>* big_integer;
+        number_integer_t        number_integer;
+        number_unsigned_t       number_unsigned;
+        number_float_t          number_float;
+        boolean_t               boolean;
     }   m_data;
 
+#else // SJSON_COMPACT_VALUE
+
+    static_assert(sizeof(void*) == 8, "SJSON_COMPACT_VALUE requires 64-bit pointers");
+    static_assert(std::numeric_limits<number_float_t>::is_iec559 && sizeof(number_float_t) == 8,
+                  "SJSON_COMPACT_VALUE requires an IEEE 754 double as number_float_t");
+    static_assert(sizeof(number_integer_t) <= 8, "SJSON_COMPACT_VALUE requires a 64-bit number_integer_t");
+
+    // the high 16 bits of a boxed value, every one of them is a negative quiet NaN with a
+    // non-zero payload, real NaNs are stored as canonical_nan so they never collide
+    enum : std::uint64_t
+    {
+        tag_packed      = 0xFFF8,   // pointer to a json_node<packed_t>
+        tag_null        = 0xFFF9,
+        tag_boolean     = 0xFFFA,
+        tag_integer     = 0xFFFB,   // 48-bit signed integer
+        tag_object      = 0xFFFC,
+        tag_array       = 0xFFFD,
+        tag_string      = 0xFFFE,
+        tag_boxed       = 0xFFFF,   // pointer to a boxed number, see box_kind
+    };
+
+    // the low bits of a boxed number pointer, nodes are at least 8-byte aligned
+    enum : std::uint64_t
+    {
+        box_integer     = 0,        // json_node<number_integer_t>
+        box_unsigned    = 1,        // json_node<number_unsigned_t>
+        box_big_integer = 2,        // json_node<number_big_integer_t>
+        box_mask        = 7,
+    };
+
+    static constexpr std::uint64_t payload_mask     = 0x0000FFFFFFFFFFFFull;
+    static constexpr std::uint64_t canonical_nan    = 0x7FF8000000000000ull;
+    static constexpr number_integer_t inline_max    = (number_integer_t(1) << 47) - 1;
+    static constexpr number_integer_t inline_min    = -(number_integer_t(1) << 47);
+
+public:
+    value_t type()const noexcept
+    {
+        switch (m_bits >> 48)
+        {
+            case tag_null:          return value_t::null;
+            case tag_boolean:       return value_t::boolean;
+            case tag_integer:       return value_t::number_integer;
+            case tag_object:        return value_t::object;
+            case tag_array:         return value_t::array;
+            case tag_packed:        return value_t::array;
+            case tag_string:        return value_t::string;
+            case tag_boxed:         return boxed_type();
+            default:                return value_t::number_float;
+        }
+    }
+
+    number_integer_t integer_value()const noexcept
+    {
+        if ((m_bits >> 48) == tag_integer)
+        {
+            // sign extend the 48-bit payload
+            return static_cast<number_integer_t>(static_cast<std::int64_t>(m_bits << 16) >> 16);
+        }
+
+        return boxed<number_integer_t>()->value;
+    }
+
+    number_unsigned_t unsigned_value()const noexcept
+    {
+        return boxed<number_unsigned_t>()->value;
+    }
+
+    number_float_t float_value()const noexcept
+    {
+        number_float_t num;
+        std::memcpy(&num, &m_bits, sizeof(num));
+        return num;
+    }
+
+    boolean_t boolean_value()const noexcept
+    {
+        return (m_bits & payload_mask) != 0;
+    }
+
+    void swap(json_value& other)noexcept
+    {
+        std::swap(m_bits, other.m_bits);
+    }
+
+private:
+    template<typename Ty>
+    Ty* pointer()const noexcept
+    {
+        return reinterpret_cast<Ty*>(static_cast<std::uintptr_t>(m_bits & payload_mask));
+    }
+
+    // whether a node address fits in the 48-bit payload, checked by create()
+    static bool addressable(const void* ptr)noexcept
+    {
+        return (static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr)) & ~payload_mask) == 0;
+    }
+
+    // ptr comes from create(), or from a value that already held it
+    void set_pointer(std::uint64_t tag, const void* ptr)noexcept
+    {
+        m_bits = (tag << 48) | static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr));
+    }
+
+    json_node<object_t>*    object_ptr()const noexcept  { return pointer<json_node<object_t>>();    }
+    json_node<array_t>*     array_ptr()const noexcept   { return pointer<json_node<array_t>>();     }
+    json_node<string_t>*    string_ptr()const noexcept  { return pointer<json_node<string_t>>();    }
+    json_node<packed_t>*    packed_ptr()const noexcept  { return pointer<json_node<packed_t>>();    }
+    json_node<number_big_integer_t>* big_integer_ptr()const noexcept { return boxed<number_big_integer_t>(); }
+
+    value_t boxed_type()const noexcept
+    {
+        switch (m_bits & box_mask)
+        {
+            case box_unsigned:      return value_t::number_unsigned;
+            case box_big_integer:   return value_t::number_big_integer;
+            default:                return value_t::number_integer;
+        }
+    }
+
+    template<typename Ty>
+    json_node<Ty>* boxed()const noexcept
+    {
+        return reinterpret_cast<json_node<Ty>*>(static_cast<std::uintptr_t>(m_bits & payload_mask & ~std::uint64_t(box_mask)));
+    }
+
+    template<typename Ty>
+    void set_boxed(std::uint64_t kind, json_node<Ty>* node)noexcept
+    {
+        static_assert(alignof(json_node<Ty>) > box_mask, "boxed numbers need 8-byte aligned nodes");
+        set_pointer(tag_boxed, node);
+        m_bits |= kind;
+    }
+
+    bool is_boxed(std::uint64_t kind)const noexcept
+    {
+        return (m_bits >> 48) == tag_boxed && (m_bits & box_mask) == kind;
+    }
+
+    bool packed_tagged()const noexcept  { return (m_bits >> 48) == tag_packed; }
+
+    // the node of a boxed integer or unsigned, nullptr for an inline integer
+    template<typename Ty>
+    const json_node<Ty>* boxed_number_ptr()const noexcept
+    {
+        return (m_bits >> 48) == tag_boxed ? boxed<Ty>() : nullptr;
+    }
+
+    void set_null()noexcept                 { m_bits = std::uint64_t(tag_null) << 48; }
+    void set_object(json_node<object_t>* obj)noexcept   { set_pointer(tag_object, obj); }
+    void set_array(json_node<array_t>* arr)noexcept     { set_pointer(tag_array, arr);  }
+    void set_packed(json_node<packed_t>* arr)noexcept   { set_pointer(tag_packed, arr); }
+    void set_string(json_node<string_t>* str)noexcept   { set_pointer(tag_string, str); }
+
+    void set_integer(number_integer_t num)
+    {
+        if (num >= inline_min && num <= inline_max)
+        {
+            m_bits = (std::uint64_t(tag_integer) << 48) | (static_cast<std::uint64_t>(num) & payload_mask);
+        }
+        else
+        {
+            set_boxed(box_integer, create<number_integer_t>(num));
+        }
+    }
+
+    void set_unsigned(number_unsigned_t num)
+    {
+        set_boxed(box_unsigned, create<number_unsigned_t>(num));
+    }
+
+    void set_big_integer(json_node<number_big_integer_t>* num)noexcept
+    {
+        set_boxed(box_big_integer, num);
+    }
+
+    void set_float(number_float_t num)noexcept
+    {
+        if (num != num)
+        {
+            m_bits = canonical_nan;
+        }
+        else
+        {
+            std::memcpy(&m_bits, &num, sizeof(num));
+        }
+    }
+
+    void set_boolean(boolean_t val)noexcept
+    {
+        m_bits = (std::uint64_t(tag_boolean) << 48) | (val ? 1u : 0u);
+    }
+
+    void copy_integer(const json_value& other)
+    {
+        if (other.is_boxed(box_integer))
+        {
+            set_boxed(box_integer, share(other.boxed<number_integer_t>()));
+        }
+        else
+        {
+            m_bits = other.m_bits;
+        }
+    }
+
+    void copy_unsigned(const json_value& other)
+    {
+        set_boxed(box_unsigned, share(other.boxed<number_unsigned_t>()));
+    }
+
+    void destroy_integer()noexcept
+    {
+        if (is_boxed(box_integer))
+        {
+            release(boxed<number_integer_t>());
+        }
+    }
+
+    void destroy_unsigned()noexcept
+    {
+        release(boxed<number_unsigned_t>());
+    }
+
+    void steal(json_value& other)noexcept
+    {
+        m_bits = other.m_bits;
+        other.set_null();
+    }
+
+private:
+    std::uint64_t   m_bits;
+
+#endif // SJSON_COMPACT_VALUE
+
 };
 
 
@@ -409,4 +1934,4 @@ public:
 } // namespace sjson
 
 
-#endif  // JSON_VALUE_HPP
\ No newline at end of file
+#endif  // JSON_VALUE_HPP
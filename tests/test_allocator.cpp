@@ -0,0 +1,75 @@
+#include "test.h"
+#include <thread>
+#include <vector>
+
+using pool_json = sjson::pool_json;
+
+int main()
+{
+    const std::string text = "{\"id\": 9223372036854775807, \"name\": \"pool\", \"tags\": [\"a\", \"b\", [1, 2.5, null]], \"nested\": {\"ok\": true}}";
+
+    // nodes come from the pool and go back to it
+    pool_json j0 = pool_json::parse(text);
+    pool_json j1 = j0;
+    j1["nested"]["ok"] = false;
+    JSON_ASSERT(j0["nested"]["ok"] == true);
+    JSON_ASSERT(j1["tags"][2][1] == 2.5);
+    JSON_ASSERT(j0.dump() == json::parse(text).dump());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        pool_json tmp = j0;
+        tmp["tags"].push_back(i);
+        tmp["name"] = std::string(64, 'x');
+    }
+
+    // every thread has its own free lists
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&text]
+        {
+            for (int i = 0; i < 200; ++i)
+            {
+                pool_json doc = pool_json::parse(text);
+                doc["tags"].push_back(i);
+                JSON_ASSERT(doc["tags"].size() == 4);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // a document built on one thread and destroyed on another
+    pool_json moved;
+    std::thread producer([&moved, &text] { moved = pool_json::parse(text); });
+    producer.join();
+    JSON_ASSERT(moved["name"] == "pool");
+    moved = nullptr;
+
+    // blocks freed on the release thread go back to the thread that allocated them
+    pool_json doc;
+    std::size_t chunks = 0;
+    for (int round = 0; round < 20; ++round)
+    {
+        doc = pool_json::array({});
+        for (int i = 0; i < 2000; ++i)
+        {
+            doc.push_back(pool_json::parse(text));
+        }
+        doc.clear_async();
+        sjson::detail::json_release_queue<pool_json>::instance().flush();
+
+        if (round == 1)
+        {
+            chunks = sjson::detail::node_pool::chunk_count();
+        }
+    }
+    JSON_ASSERT(sjson::detail::node_pool::chunk_count() == chunks);
+
+    std::cout << color::F_GREEN << j0 << "\n" << j1 << "\n" << color::CLEAR_F;
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef SJSON_ATOM_KEYS
+#define SJSON_ATOM_KEYS
+#endif
+#include "test.h"
+#include <vector>
+
+int main()
+{
+    using atom = json::key_t;
+
+    // equal keys are one atom
+    const atom a0 = "name";
+    const atom a1 = std::string("name");
+    const atom a2 = "id";
+    JSON_ASSERT(a0 == a1 && &a0.str() == &a1.str());
+    JSON_ASSERT(a0 != a2 && a2 < a0);
+    JSON_ASSERT(a0 == "name" && a0 == std::string("name"));
+
+    // every document shares the key strings
+    std::vector<json> docs;
+    for (int i = 0; i < 100; ++i)
+    {
+        docs.push_back(json::parse("{\"id\": " + std::to_string(i) + ", \"name\": \"doc\", \"tags\": {\"x\": 1}}"));
+    }
+
+    const auto& first = docs.front().as_object();
+    const auto& last = docs.back().as_object();
+    JSON_ASSERT(&first.begin()->first.str() == &last.begin()->first.str());
+    JSON_ASSERT(&first.begin()->first.str() == &a2.str());
+
+    json j0;
+    j0["name"] = "built";
+    j0[std::string("id")] = 7;
+    JSON_ASSERT(j0.contains("name") && !j0.contains("missing"));
+    JSON_ASSERT(j0.begin().key() == "id");
+    JSON_ASSERT(j0.dump() == "{\"id\":7,\"name\":\"built\"}");
+    JSON_ASSERT(docs[42]["id"] == 42 && docs[42]["tags"]["x"] == 1);
+
+    // a lookup of a key no object has does not intern it
+    const json& doc = docs[7];
+    const std::size_t interned = atom::table_type::size();
+    for (int i = 0; i < 1000; ++i)
+    {
+        const std::string key = "missing" + std::to_string(i);
+        JSON_ASSERT(!doc.contains(key) && doc.find(key) == doc.end());
+    }
+    JSON_ASSERT(atom::table_type::size() == interned && doc.contains("name") && doc.contains(std::string("tags")));
+
+    std::cout << color::F_GREEN << j0 << "\n" << docs[99] << "\n" << j0.begin().key() << "\n" << color::CLEAR_F;
+
+    return 0;
+}
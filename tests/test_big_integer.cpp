@@ -0,0 +1,102 @@
+#ifndef SJSON_BIG_INTEGERS
+#define SJSON_BIG_INTEGERS
+#endif
+#include "test.h"
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+
+int main()
+{
+    // unsigned 64-bit values keep every bit
+    const std::uint64_t hash = 18446744073709551615ull;
+    json j0 = json::parse("{\"hash\": 18446744073709551615, \"id\": 9223372036854775808, \"min\": -9223372036854775808, \"small\": 42}");
+    JSON_ASSERT(j0["hash"].is_unsigned() && j0["hash"].is_integer());
+    JSON_ASSERT(j0["hash"].get<std::uint64_t>() == hash);
+    JSON_ASSERT(j0["id"].as_unsigned() == 9223372036854775808ull);
+    JSON_ASSERT(j0["min"].get<std::int64_t>() == std::numeric_limits<std::int64_t>::min());
+    JSON_ASSERT(!j0["small"].is_unsigned() && j0["small"] == json(42u));
+    JSON_ASSERT(j0["hash"] == json(hash) && j0["hash"] != json(-1));
+    JSON_ASSERT(j0.dump() == "{\"hash\":18446744073709551615,\"id\":9223372036854775808,\"min\":-9223372036854775808,\"small\":42}");
+
+    // but never read as a signed value they do not fit in
+    for (const auto& unsigned_value : { j0["hash"], j0["id"] })
+    {
+        bool thrown = false;
+        try
+        {
+            unsigned_value.as_int();
+        }
+        catch (const sjson::detail::json_type_error&)
+        {
+            thrown = true;
+        }
+        JSON_ASSERT(thrown);
+
+        thrown = false;
+        try
+        {
+            unsigned_value.get<std::int64_t>();
+        }
+        catch (const sjson::detail::json_type_error&)
+        {
+            thrown = true;
+        }
+        JSON_ASSERT(thrown);
+    }
+
+    bool narrowed = false;
+    try
+    {
+        j0["hash"].get<std::uint32_t>();
+    }
+    catch (const sjson::detail::json_type_error&)
+    {
+        narrowed = true;
+    }
+    JSON_ASSERT(narrowed && j0["small"].as_int() == 42);
+
+    // wider integers are kept exactly as big integers
+    json j1 = json::parse("[123456789012345678901234567890, -18446744073709551616, 1e2]");
+    JSON_ASSERT(j1[0].is_big_integer() && j1[1].is_big_integer() && j1[2].is_float());
+    JSON_ASSERT(j1[0].as_big_integer().str() == "123456789012345678901234567890");
+    JSON_ASSERT(j1[1].as_big_integer() < json::number_big_integer_t(std::numeric_limits<std::int64_t>::min()));
+    JSON_ASSERT(j1[0].as_float() == std::strtod("123456789012345678901234567890", nullptr));
+    JSON_ASSERT(j1[1].as_float() == -18446744073709551616.0);
+    JSON_ASSERT(json::number_big_integer_t("9007199254740993").to_float<double>() == 9007199254740992.0);
+    JSON_ASSERT(j1.dump() == "[123456789012345678901234567890,-18446744073709551616,100]");
+    JSON_ASSERT(json(json::number_big_integer_t("0042")) == json(42));
+
+    // and compared exactly with floats, not rounded to one
+    const json big = json::parse("18446744073709551617");
+    const json near = json::parse("18446744073709551616.0");
+    JSON_ASSERT(big != near && near < big && !(big < near));
+    JSON_ASSERT(json::parse("18446744073709551616") == near && json::parse("-18446744073709551616") == json(-18446744073709551616.0));
+    JSON_ASSERT(json(json::number_big_integer_t("-18446744073709551617")) < json(-18446744073709551616.0));
+    JSON_ASSERT(json::parse("1" + std::string(400, '0')) < json(std::numeric_limits<double>::infinity()));
+    JSON_ASSERT(json::parse("1" + std::string(400, '0')) > json(std::numeric_limits<double>::max()));
+    JSON_ASSERT(json(json::number_big_integer_t("1")) > json(0.5) && json(json::number_big_integer_t("1")) < json(1.5));
+
+    json j2 = j1;
+    JSON_ASSERT(j2 == j1);
+
+    // the tape keeps them too
+    const auto tape = sjson::json_tape::parse(j0.dump());
+    JSON_ASSERT(tape.root()["hash"].as_unsigned() == hash);
+    bool tape_thrown = false;
+    try
+    {
+        tape.root()["hash"].as_int();
+    }
+    catch (const sjson::detail::json_type_error&)
+    {
+        tape_thrown = true;
+    }
+    JSON_ASSERT(tape_thrown && tape.root()["small"].as_int() == 42);
+    JSON_ASSERT(sjson::json_tape::from_json(j1).to_json() == j1);
+
+    std::cout << color::F_GREEN << j0 << "\n" << j1 << "\n" << color::CLEAR_F;
+
+    return 0;
+}
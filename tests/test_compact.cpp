@@ -0,0 +1,101 @@
+#ifndef SJSON_COMPACT_VALUE
+#define SJSON_COMPACT_VALUE
+#endif
+#include "test.h"
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <memory>
+
+// hands out one address above 48 bits, which a compact value cannot hold.
+// it is never dereferenced, the node is given back before it is constructed
+static int high_allocations = 0;
+static int high_deallocations = 0;
+
+template<typename Ty>
+struct high_address_allocator
+{
+    using value_type = Ty;
+
+    high_address_allocator() = default;
+
+    template<typename Other>
+    high_address_allocator(const high_address_allocator<Other>&) { }
+
+    static Ty* high_address() { return reinterpret_cast<Ty*>(std::uintptr_t(1) << 56); }
+
+    Ty* allocate(std::size_t count)
+    {
+        if (high_allocations++ == 0)
+        {
+            return high_address();
+        }
+        return std::allocator<Ty>().allocate(count);
+    }
+
+    void deallocate(Ty* ptr, std::size_t count)
+    {
+        if (ptr == high_address())
+        {
+            ++high_deallocations;
+            return;
+        }
+        std::allocator<Ty>().deallocate(ptr, count);
+    }
+
+    friend bool operator==(const high_address_allocator&, const high_address_allocator&) { return true;  }
+    friend bool operator!=(const high_address_allocator&, const high_address_allocator&) { return false; }
+};
+
+using high_json = sjson::detail::basic_json<std::map, std::vector, std::string, std::int64_t, double, bool, high_address_allocator>;
+
+int main()
+{
+    static_assert(sizeof(json) == 8, "compact json value must be 8 bytes");
+
+    json j0 = nullptr;
+    json j1 = true;
+    json j2 = 233;
+    json j3 = -140737488355328LL;                   // -2^47, still stored inline
+    json j4 = 9223372036854775807LL;                // boxed integer
+    json j5 = 3.14159265358;
+    json j6 = std::numeric_limits<double>::quiet_NaN();
+    json j7 = "compact";
+    json j8 = json::array({ 0, 1.5, true, nullptr, "str", 4611686018427387904LL });
+
+    JSON_ASSERT(j0.is_null());
+    JSON_ASSERT(j1.get<bool>() == true);
+    JSON_ASSERT(j2.get<int>() == 233);
+    JSON_ASSERT(j3.get<long long>() == -140737488355328LL);
+    JSON_ASSERT(j4.get<long long>() == 9223372036854775807LL);
+    JSON_ASSERT(j5.get<double>() == 3.14159265358);
+    JSON_ASSERT(j6.is_float() && std::isnan(j6.get<double>()));
+    JSON_ASSERT(j7.get<std::string>() == "compact");
+    JSON_ASSERT(j8.size() == 6 && j8[5].get<long long>() == 4611686018427387904LL);
+
+    json j9 = j8;
+    JSON_ASSERT(j9 == j8);
+    j9[5] = -1;
+    JSON_ASSERT(j8[5] != j9[5]);
+
+    json j10 = json::parse("{\"id\": 18014398509481984, \"neg\": -7, \"pi\": 3.5, \"ok\": false}");
+    JSON_ASSERT(j10["id"].get<long long>() == 18014398509481984LL);
+    JSON_ASSERT(j10["neg"].get<int>() == -7);
+
+    // a node the value cannot address is freed, not leaked
+    bool thrown = false;
+    try
+    {
+        high_json high = high_json::parse("{\"key\": \"value\"}");
+    }
+    catch (const sjson::detail::json_exception&)
+    {
+        thrown = true;
+    }
+    JSON_ASSERT(thrown && high_deallocations == 1);
+    JSON_ASSERT(high_json::parse("[1, \"two\"]")[1] == "two");
+
+    std::cout << color::F_GREEN << j8 << "\n" << j10 << "\n" << color::CLEAR_F;
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef SJSON_PACKED_ARRAYS
+#define SJSON_PACKED_ARRAYS
+#endif
+#include "test.h"
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <limits>
+
+int main()
+{
+    // values of different types are not equal, nothing is thrown
+    JSON_ASSERT(json(1) != json("1") && json() != json(false) && json::parse("[]") != json::parse("{}"));
+    JSON_ASSERT(json(1) == json(1.0) && json(-1) != json(18446744073709551615ull));
+
+    // integers and floats compare exactly
+    const std::int64_t big = (std::int64_t(1) << 53) + 1;
+    JSON_ASSERT(json(big) != json(static_cast<double>(big)) && json(big) > json(static_cast<double>(big)));
+    JSON_ASSERT(json(2) < json(2.5) && json(3) > json(2.5) && json(-1) < json(0u));
+    JSON_ASSERT(json(std::numeric_limits<double>::quiet_NaN()) > json(1e308));
+
+    // NaN equals NaN, so operator==, compare() and hash() agree
+    const json nan(std::numeric_limits<double>::quiet_NaN());
+    const json negative_nan(-std::numeric_limits<double>::quiet_NaN());
+    JSON_ASSERT(nan == negative_nan && !(nan != negative_nan) && !(nan < negative_nan) && nan.hash() == negative_nan.hash());
+    JSON_ASSERT(nan != json(1.0) && nan != json(1) && json(0.0) == json(-0.0) && json(0.0).hash() == json(-0.0).hash());
+    json nan_array = json::parse("[1.5, 2.5]");
+    json negative_nan_array = nan_array;
+    nan_array.push_back(nan);
+    negative_nan_array.push_back(negative_nan);
+    JSON_ASSERT(nan_array.is_packed() && nan_array == negative_nan_array && nan_array.hash() == negative_nan_array.hash());
+    JSON_ASSERT(json::array({ nan, "s" }) == json::array({ negative_nan, "s" }));
+
+    // a total order across types
+    std::vector<json> values = {
+        json::parse("{\"a\": 1}"), json::parse("[1, 2]"), json("b"), json(2.5), json(true),
+        json(), json::parse("[1]"), json("a"), json(-3), json(false), json::parse("{\"a\": 0}")
+    };
+    std::sort(values.begin(), values.end());
+    JSON_ASSERT(json(values).dump() == "[null,false,true,-3,2.5,\"a\",\"b\",[1],[1,2],{\"a\":0},{\"a\":1}]");
+    JSON_ASSERT(!(values[3] < values[3]) && values[3] <= values[3] && values[4] >= values[3]);
+
+    std::set<json> unique;
+    unique.insert(json::parse("{\"x\": [1, 2]}"));
+    unique.insert(json::parse("{\"x\": [1.0, 2.0]}"));
+    unique.insert(json::parse("{\"x\": [1, 3]}"));
+    JSON_ASSERT(unique.size() == 2);
+
+    // packed and general arrays compare by their elements
+    json packed = json::parse("[1, 2, 3]");
+    json general = json::array({ 1, 2, "three" });
+    JSON_ASSERT(packed.is_packed() && !general.is_packed());
+    JSON_ASSERT(packed != general && packed < general && json::parse("[1, 2]") < packed);
+    JSON_ASSERT(packed == json::parse("[1.0, 2.0, 3.0]") && packed != json::parse("[true, false, true]"));
+    JSON_ASSERT(json::parse("[1, 2, 4]") > packed && json::parse("[1, 2]") != packed);
+
+    std::cout << color::F_GREEN << json(values) << "\n" << color::CLEAR_F;
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef SJSON_COPY_ON_WRITE
+#define SJSON_COPY_ON_WRITE
+#endif
+#include "test.h"
+
+int main()
+{
+    const json templ = json::parse("{\"head\": {\"id\": 1, \"tags\": [\"a\", \"b\"]}, \"body\": {\"text\": \"hello\"}}");
+
+    // copies share the whole tree
+    const json copy0 = templ;
+    JSON_ASSERT(&copy0.as_object() == &templ.as_object());
+    JSON_ASSERT(&copy0["head"].as_object() == &templ["head"].as_object());
+
+    // a change only clones the path to the changed node
+    json copy1 = templ;
+    copy1["head"]["id"] = 2;
+    JSON_ASSERT(templ["head"]["id"] == 1);
+    JSON_ASSERT(copy1["head"]["id"] == 2);
+    JSON_ASSERT(&copy1.as_object() != &templ.as_object());
+    JSON_ASSERT(&copy1["head"].as_object() != &templ["head"].as_object());
+    JSON_ASSERT(&static_cast<const json&>(copy1)["body"].as_object() == &templ["body"].as_object());
+    JSON_ASSERT(&static_cast<const json&>(copy1)["head"]["tags"].as_array() == &templ["head"]["tags"].as_array());
+
+    // a JSON Patch test reads without detaching
+    json tested = templ;
+    tested.apply_patch(json::parse(R"([{"op": "test", "path": "/head/tags/0", "value": "a"}])"));
+    JSON_ASSERT(&static_cast<const json&>(tested).as_object() == &templ.as_object());
+
+    // a pinned container is cloned, the old reference never writes into the copy
+    json doc = templ;
+    auto& body = doc["body"];
+    const json snapshot = doc;
+    body = "changed";
+    JSON_ASSERT(doc["body"] == "changed");
+    JSON_ASSERT(snapshot["body"]["text"] == "hello");
+
+    // copying a container into itself
+    json arr = json::array({ 0, 1, 2 });
+    arr.push_back(arr);
+    arr.push_back(arr[3]);
+    JSON_ASSERT(arr.size() == 5 && arr[3].size() == 3 && arr[4].size() == 3);
+
+    json self = templ;
+    self["self"] = self;
+    self["self"]["self"] = self;
+    JSON_ASSERT(self["self"]["self"]["self"]["head"] == templ["head"]);
+
+    std::cout << color::F_GREEN << copy1 << "\n" << snapshot << "\n" << arr << "\n" << color::CLEAR_F;
+
+    return 0;
+}
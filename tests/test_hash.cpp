@@ -0,0 +1,46 @@
+#ifndef SJSON_HASH_CACHE
+#define SJSON_HASH_CACHE
+#endif
+#include "test.h"
+#include <unordered_map>
+
+int main()
+{
+    const std::hash<json> hasher;
+
+    // equal documents hash equally, whatever the member order or number type
+    json j0 = json::parse("{\"id\": 1, \"tags\": [\"a\", \"b\"], \"score\": 2.5, \"ok\": true}");
+    json j1 = json::parse("{\"ok\": true, \"score\": 2.5, \"tags\": [\"a\", \"b\"], \"id\": 1.0}");
+    JSON_ASSERT(j0 == j1 && hasher(j0) == hasher(j1) && j0.hash() == j1.hash());
+    JSON_ASSERT(json(0.0).hash() == json(-0.0).hash() && json(7).hash() == json(7u).hash());
+
+    // and different ones differently
+    JSON_ASSERT(json::parse("[1, 2]").hash() != json::parse("[2, 1]").hash());
+    JSON_ASSERT(json::parse("{\"a\": 1, \"b\": 2}").hash() != json::parse("{\"a\": 2, \"b\": 1}").hash());
+    JSON_ASSERT(json().hash() != json(false).hash() && json(false).hash() != json(0).hash());
+    JSON_ASSERT(json("1").hash() != json(1).hash() && json::parse("[]").hash() != json::parse("{}").hash());
+
+    // a cached hash follows changes
+    const auto before = j0.hash();
+    JSON_ASSERT(j0.hash() == before);
+    j0["tags"].push_back("c");
+    JSON_ASSERT(j0.hash() != before);
+    j0["tags"].pop_back();
+    JSON_ASSERT(j0.hash() == before);
+
+    json& tags = j0["tags"];
+    JSON_ASSERT(j0.hash() == before);
+    tags[0] = "z";
+    JSON_ASSERT(j0.hash() != before && j0 != j1);
+
+    // documents as keys
+    std::unordered_map<json, int> counts;
+    ++counts[json::parse("{\"x\": [1, 2], \"y\": null}")];
+    ++counts[json::parse("{\"y\": null, \"x\": [1, 2]}")];
+    ++counts[json::parse("{\"y\": null, \"x\": [2, 1]}")];
+    JSON_ASSERT(counts.size() == 2 && counts[json::parse("{\"x\":[1,2],\"y\":null}")] == 2);
+
+    std::cout << color::F_GREEN << j0 << " " << j0.hash() << "\n" << color::CLEAR_F;
+
+    return 0;
+}
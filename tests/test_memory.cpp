@@ -0,0 +1,51 @@
+#ifndef SJSON_MEMORY_STATS
+#define SJSON_MEMORY_STATS
+#endif
+#include "test.h"
+
+int main()
+{
+    using stats = sjson::json_allocation_stats;
+
+    const auto before = stats::get();
+    {
+        const json doc = json::parse(R"({
+            "name": "a string long enough to leave the inline buffer",
+            "short": "abc",
+            "a key long enough to leave the inline buffer too": [1, 2.5, true, null, 140737488355328],
+            "nested": {"list": [{"k": "v"}, {"k": "w"}]}
+        })");
+
+        const auto usage = doc.memory_usage();
+        JSON_ASSERT(usage.objects == 4 && usage.arrays == 2 && usage.string_count == 4);
+        JSON_ASSERT(usage.strings > 40 && usage.elements > 0 && usage.total() > usage.nodes);
+#if !defined(SJSON_ATOM_KEYS)
+        JSON_ASSERT(usage.keys > 40);
+#endif
+
+        // every node of the document was counted by the allocation stats
+        const auto after = stats::get();
+        JSON_ASSERT(after.live_bytes() - before.live_bytes() == usage.nodes);
+        JSON_ASSERT(after.live_nodes() > before.live_nodes());
+    }
+    JSON_ASSERT(stats::get().live_bytes() == before.live_bytes());
+
+    // reserved but unused storage is slack
+    json list;
+    list.reserve(100);
+    list.push_back("one");
+    const auto reserved = list.memory_usage();
+    JSON_ASSERT(reserved.slack >= 99 * sizeof(json) && reserved.elements == sizeof(json));
+    list.shrink_to_fit();
+    JSON_ASSERT(list.memory_usage().slack == 0);
+
+    // scalars hold no heap memory, a pool allocator rounds nodes up to its size classes
+    JSON_ASSERT(json(1).memory_usage().total() == 0 && json().memory_usage().total() == 0);
+    const auto pooled = sjson::pool_json::parse(R"({"a": [1, "x"], "b": "y"})").memory_usage();
+    JSON_ASSERT(pooled.nodes > 0 && pooled.nodes % 16 == 0);
+
+    std::cout << color::F_GREEN << "nodes " << reserved.nodes << ", elements " << reserved.elements
+        << ", slack " << reserved.slack << "\n" << color::CLEAR_F;
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#ifndef SJSON_PACKED_ARRAYS
+#define SJSON_PACKED_ARRAYS
+#endif
+#include "test.h"
+#include <vector>
+#include <thread>
+
+int main()
+{
+    // homogeneous arrays are packed by the parser
+    json j0 = json::parse("{\"ts\": [1, 2, 3, -4], \"emb\": [0.5, 1.25, -2.0], \"mask\": [true, false, true], \"mix\": [1, 2.5]}");
+    JSON_ASSERT(j0["ts"].is_packed() && j0["emb"].is_packed() && j0["mask"].is_packed());
+    JSON_ASSERT(!j0["mix"].is_packed());
+
+    const json& ts = j0["ts"];
+    const auto ints = ts.as_span<json::number_integer_t>();
+    JSON_ASSERT(ints.size() == 4 && ints[3] == -4 && ts.size() == 4);
+
+    const auto floats = j0["emb"].as_span<double>();
+    double sum = 0.0;
+    for (const double val : floats)
+    {
+        sum += val;
+    }
+    JSON_ASSERT(sum == -0.25);
+
+    JSON_ASSERT(j0.dump() == "{\"emb\":[0.5,1.25,-2],\"mask\":[true,false,true],\"mix\":[1,2.5],\"ts\":[1,2,3,-4]}");
+    JSON_ASSERT(j0["ts"] == json::array({ 1, 2, 3, -4 }));
+    JSON_ASSERT(j0["ts"].get<json::array_t>().size() == 4);
+
+    // const access reads a packed array in place, it stays packed
+    const json& cts = j0["ts"];
+    const json& first = cts[0];
+    const json& last = cts.at(3);
+    JSON_ASSERT(first == 1 && last == -4 && &first != &last && cts.is_packed());
+    std::vector<json> forward(cts.begin(), cts.end());
+    std::vector<json> backward(cts.rbegin(), cts.rend());
+    JSON_ASSERT(forward.size() == 4 && forward[3] == -4 && backward[0] == -4 && backward[3] == 1);
+    JSON_ASSERT(cts.begin()->get<int>() == 1 && *(cts.rbegin()) == -4 && cts.is_packed());
+    JSON_ASSERT(cts.as_array().size() == 4 && cts.as_array()[2] == 3 && cts.is_packed());
+    JSON_ASSERT(j0["mask"].is_packed() && static_cast<const json&>(j0)["mask"][1] == false);
+
+    // an element view is built for the chunk read, not for the whole array
+    json wide = json::array({});
+    for (int i = 0; i < 10000; ++i)
+    {
+        wide.push_back(i);
+    }
+    const json& cwide = wide;
+    const auto before = cwide.memory_usage().total();
+    JSON_ASSERT(cwide[5000] == 5000 && cwide.is_packed());
+    JSON_ASSERT(cwide.memory_usage().total() - before < 4096);
+
+    // and several threads may read it at once
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&cwide, t]()
+        {
+            long long sum = 0;
+            for (const auto& element : cwide)
+            {
+                sum += element.get<long long>();
+            }
+            JSON_ASSERT(sum == 49995000);
+            for (int i = t; i < 10000; i += 97)
+            {
+                JSON_ASSERT(cwide[i] == i && cwide.at(i) == i);
+            }
+        });
+    }
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    JSON_ASSERT(cwide.is_packed());
+
+    // JSON Patch test and copy only read it
+    json holder = json::parse(R"({"ts": [1, 2, 3]})");
+    holder.apply_patch(json::parse(R"([{"op": "test", "path": "/ts/1", "value": 2}, {"op": "copy", "from": "/ts/2", "path": "/last"}])"));
+    JSON_ASSERT(holder["ts"].is_packed() && holder["last"] == 3);
+
+    // a mutable iterator unpacks it
+    json reversed = json::parse("[1, 2, 3]");
+    std::vector<json> elements(reversed.rbegin(), reversed.rend());
+    JSON_ASSERT(!reversed.is_packed() && elements.front() == 3 && elements.back() == 1);
+
+    // mutation of the same type keeps it packed, anything else unpacks
+    json j1 = j0["ts"];
+    j1.push_back(5);
+    j1.pop_back();
+    j1.push_back(6);
+    JSON_ASSERT(j1.is_packed() && j1.size() == 5 && j0["ts"].size() == 4);
+
+    j1.push_back("seven");
+    JSON_ASSERT(!j1.is_packed() && j1.size() == 6 && j1[4] == 6 && j1[5] == "seven");
+
+    json j2 = json::parse("[1.5, 2.5]");
+    j2[0] = 3.5;
+    JSON_ASSERT(!j2.is_packed() && j2.dump() == "[3.5,2.5]");
+
+    bool thrown = false;
+    try
+    {
+        j0["mask"].as_span<double>();
+    }
+    catch (const sjson::detail::json_type_error&)
+    {
+        thrown = true;
+    }
+    JSON_ASSERT(thrown);
+
+    std::cout << color::F_GREEN << j0 << "\n" << j1 << "\n" << std::setw(2) << j0["emb"] << "\n" << color::CLEAR_F;
+
+    return 0;
+}
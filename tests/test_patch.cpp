@@ -0,0 +1,108 @@
+#include "test.h"
+
+int main()
+{
+    // RFC 6902 JSON Patch
+    json j0 = json::parse(R"({"name": "sjson", "tags": ["a", "b"], "meta": {"v": 1}})");
+    j0.apply_patch(json::parse(R"([
+        {"op": "add",     "path": "/tags/1",    "value": "x"},
+        {"op": "add",     "path": "/tags/-",    "value": "z"},
+        {"op": "remove",  "path": "/tags/0"},
+        {"op": "replace", "path": "/name",      "value": "json"},
+        {"op": "move",    "from": "/meta/v",    "path": "/version"},
+        {"op": "copy",    "from": "/tags",      "path": "/meta/tags"},
+        {"op": "test",    "path": "/version",   "value": 1}
+    ])"));
+    JSON_ASSERT(j0.dump() == R"({"meta":{"tags":["x","b","z"]},"name":"json","tags":["x","b","z"],"version":1})");
+
+    // an atomic patch that fails changes nothing
+    const json before = j0;
+    const json failing = json::parse(R"([
+        {"op": "remove",  "path": "/tags/1"},
+        {"op": "move",    "from": "/name",      "path": "/meta/name"},
+        {"op": "replace", "path": "/version",   "value": 2},
+        {"op": "add",     "path": "/",          "value": {"deep": [1, 2]}},
+        {"op": "add",     "path": "/tags/-",    "value": "end"},
+        {"op": "test",    "path": "/version",   "value": 3}
+    ])");
+
+    bool thrown = false;
+    try
+    {
+        j0.apply_patch(failing);
+    }
+    catch (const sjson::detail::json_patch_error&)
+    {
+        thrown = true;
+    }
+    JSON_ASSERT(thrown && j0 == before);
+
+    // a non-atomic one keeps what was applied
+    thrown = false;
+    try
+    {
+        j0.apply_patch(failing, false);
+    }
+    catch (const sjson::detail::json_patch_error&)
+    {
+        thrown = true;
+    }
+    JSON_ASSERT(thrown && j0 != before && j0["version"] == 2 && j0["meta"]["name"] == "json");
+
+    // a value cannot be moved into itself, and a path must exist
+    json j1 = json::parse(R"({"a": {"b": 1}})");
+    for (const char* patch : { R"([{"op": "move", "from": "/a", "path": "/a/c"}])",
+                               R"([{"op": "remove", "path": "/x/y"}])",
+                               R"([{"op": "add", "path": "/a/b/c", "value": 1}])",
+                               R"([{"op": "move", "from": "/a/b", "path": "/x/y"}])",
+                               R"([{"op": "move", "from": "/a", "path": "/x/0"}])",
+                               R"([{"op": "jump", "path": "/a"}])" })
+    {
+        thrown = false;
+        try
+        {
+            j1.apply_patch(json::parse(patch));
+        }
+        catch (const sjson::detail::json_patch_error&)
+        {
+            thrown = true;
+        }
+        JSON_ASSERT(thrown && j1.dump() == R"({"a":{"b":1}})");
+    }
+
+    // RFC 7396 Merge Patch
+    json j2 = json::parse(R"({"title": "Goodbye!", "author": {"givenName": "John", "familyName": "Doe"}, "tags": ["example", "sample"], "content": "This will be unchanged"})");
+    j2.merge_patch(json::parse(R"({"title": "Hello!", "phoneNumber": "+01-123-456-7890", "author": {"familyName": null}, "tags": ["example"]})"));
+    JSON_ASSERT(j2 == json::parse(R"({"title": "Hello!", "author": {"givenName": "John"}, "tags": ["example"], "content": "This will be unchanged", "phoneNumber": "+01-123-456-7890"})"));
+
+    json j3 = json::parse(R"({"a": 1})");
+    j3.merge_patch(json::parse("[1, 2]"));
+    JSON_ASSERT(j3.dump() == "[1,2]");
+
+    // diff() produces a patch from one document to another
+    const json source = json::parse(R"({"id": 7, "items": [1, 2, {"k": "v"}, 3, 4, 5], "old": true, "same": {"deep": [1, 2]}})");
+    const json target = json::parse(R"({"id": 8, "items": [0, 1, 2, {"k": "w"}, 5, 4], "new": null, "same": {"deep": [1, 2]}})");
+    const json delta = json::diff(source, target);
+    JSON_ASSERT(json::diff(source, source).empty() && json::diff(source, json(1)).size() == 1);
+
+    json patched = source;
+    patched.apply_patch(delta);
+    JSON_ASSERT(patched == target);
+    for (const auto& operation : delta)
+    {
+        JSON_ASSERT(operation["path"].as_string().compare(0, 5, "/same") != 0);
+    }
+
+    // moved blocks of an array are found by their unique elements
+    const json rows = json::parse(R"([{"r": 1}, {"r": 2}, {"r": 3}, {"r": 4}, {"r": 5}, {"r": 6}])");
+    const json shifted = json::parse(R"([{"r": 0}, {"r": 1}, {"r": 2}, {"r": 3}, {"r": 4}, {"r": 5}, {"r": 6}])");
+    JSON_ASSERT(json::diff(rows, shifted).dump() == R"([{"op":"add","path":"/0","value":{"r":0}}])");
+
+    patched = rows;
+    patched.apply_patch(json::diff(rows, json::parse(R"([{"r": 6}, {"r": 2}, {"r": 3}, {"r": 9}, {"r": 1}])")));
+    JSON_ASSERT(patched.dump() == R"([{"r":6},{"r":2},{"r":3},{"r":9},{"r":1}])");
+
+    std::cout << color::F_GREEN << j0 << "\n" << j2 << "\n" << color::CLEAR_F;
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "test.h"
+#include <vector>
+#include <string>
+
+int main()
+{
+    using sjson::json_path;
+
+    const json store = json::parse(R"({"store": {
+        "book": [
+            {"category": "reference", "author": "Nigel Rees", "title": "Sayings of the Century", "price": 8.95},
+            {"category": "fiction", "author": "Evelyn Waugh", "title": "Sword of Honour", "price": 12.99},
+            {"category": "fiction", "author": "Herman Melville", "title": "Moby Dick", "isbn": "0-553-21311-3", "price": 8.99},
+            {"category": "fiction", "author": "J. R. R. Tolkien", "title": "The Lord of the Rings", "isbn": "0-395-19395-8", "price": 22.99}
+        ],
+        "bicycle": {"color": "red", "price": 19.95}
+    }})");
+
+    const auto texts = [](const std::vector<const json*>& nodes)
+    {
+        json result = json::parse("[]");
+        for (const auto node : nodes)
+        {
+            result.push_back(*node);
+        }
+        return result.dump();
+    };
+
+    // a query is compiled once and returns pointers into the document
+    const json_path cheap("$.store.book[?(@.price < 10)].title");
+    const auto titles = cheap.select(store);
+    JSON_ASSERT(titles.size() == 2 && titles[0] == &store["store"]["book"][0]["title"]);
+    JSON_ASSERT(texts(titles) == R"(["Sayings of the Century","Moby Dick"])");
+
+    JSON_ASSERT(texts(json_path("$..author").select(store)) == R"(["Nigel Rees","Evelyn Waugh","Herman Melville","J. R. R. Tolkien"])");
+    JSON_ASSERT(json_path("$.store.*").select(store).size() == 2);
+    JSON_ASSERT(json_path("$..price").select(store).size() == 5);
+    JSON_ASSERT(texts(json_path("$.store.book[-1].title").select(store)) == R"(["The Lord of the Rings"])");
+    JSON_ASSERT(texts(json_path("$.store.book[0,2]['title']").select(store)) == R"(["Sayings of the Century","Moby Dick"])");
+    JSON_ASSERT(texts(json_path("$.store.book[1:3].price").select(store)) == "[12.99,8.99]");
+    JSON_ASSERT(texts(json_path("$.store.book[::-2].price").select(store)) == "[22.99,12.99]");
+    JSON_ASSERT(texts(json_path("$..book[?(@.isbn)].title").select(store)) == R"(["Moby Dick","The Lord of the Rings"])");
+    JSON_ASSERT(texts(json_path("$..book[?(@.category == 'fiction' && !(@.price > 20))].price").select(store)) == "[12.99,8.99]");
+    JSON_ASSERT(texts(json_path("$..[?(@.color == \"red\" || @.price == 8.95)].price").select(store)) == "[19.95,8.95]");
+    JSON_ASSERT(json_path("$.missing[0]").select(store).empty() && json_path("$").select(store)[0] == &store);
+
+    // mutable matches
+    json j0 = store;
+    for (auto node : json_path("$.store.book[*].price").select(j0))
+    {
+        *node = 1;
+    }
+    JSON_ASSERT(texts(json_path("$..book[?(@.price == 1)].price").select(static_cast<const json&>(j0))) == "[1,1,1,1]");
+
+    // the same plan over a tape, no tree is built
+    const auto tape = sjson::json_tape::parse(store.dump());
+    const auto views = cheap.select(tape.root());
+    JSON_ASSERT(views.size() == 2 && views[1].as_string() == "Moby Dick");
+    JSON_ASSERT(json_path("$..book[?(@.isbn)].price").select(tape.root())[1].as_float() == 22.99);
+
+    for (const char* query : { "store", "$.", "$[?(@.a ==)]", "$['a'", "$[1:2" })
+    {
+        bool thrown = false;
+        try
+        {
+            json_path path(query);
+        }
+        catch (const sjson::detail::json_parse_error&)
+        {
+            thrown = true;
+        }
+        JSON_ASSERT(thrown);
+    }
+
+    std::cout << color::F_GREEN << texts(titles) << "\n" << color::CLEAR_F;
+
+    return 0;
+}
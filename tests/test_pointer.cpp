@@ -0,0 +1,60 @@
+#include "test.h"
+#include <vector>
+
+int main()
+{
+    using sjson::json_pointer;
+
+    json j0 = json::parse(R"({"user": {"name": "sjson", "tags": ["a", "b"]}, "a/b": 1, "m~n": 2, "": 3, "10": 4})");
+
+    // a pointer is parsed once and used on any document
+    const json_pointer name("/user/name");
+    const json_pointer tag("/user/tags/1");
+    JSON_ASSERT(name.size() == 2 && tag[2].index == 1 && name[0].index == json_pointer::npos);
+    JSON_ASSERT(j0.at(name) == "sjson" && j0.at(tag) == "b");
+    JSON_ASSERT(j0.at(json_pointer("")) == j0 && j0.at(json_pointer("/")) == 3);
+    JSON_ASSERT(j0.at(json_pointer("/a~1b")) == 1 && j0.at(json_pointer("/m~0n")) == 2 && j0.at(json_pointer("/10")) == 4);
+    JSON_ASSERT(json_pointer("/a~1b/m~0n").to_string() == "/a~1b/m~0n");
+
+    // missing paths
+    JSON_ASSERT(j0.contains(name) && !j0.contains(json_pointer("/user/tags/2")) && !j0.contains(json_pointer("/user/tags/-")));
+    JSON_ASSERT(!j0.contains(json_pointer("/user/tags/01")) && !j0.contains(json_pointer("/user/name/x")));
+    JSON_ASSERT(j0.value(json_pointer("/user/age"), 18) == 18 && j0.value(name, "none") == "sjson");
+    JSON_ASSERT(j0.value(json_pointer("/user/nick"), "none") == "none");
+
+    bool thrown = false;
+    try
+    {
+        j0.at(json_pointer("/user/age"));
+    }
+    catch (const sjson::detail::json_invalid_key&)
+    {
+        thrown = true;
+    }
+    JSON_ASSERT(thrown);
+
+    thrown = false;
+    try
+    {
+        json_pointer("user");
+    }
+    catch (const sjson::detail::json_parse_error&)
+    {
+        thrown = true;
+    }
+    JSON_ASSERT(thrown);
+
+    // a mutable reference
+    j0.at(tag) = "c";
+    JSON_ASSERT(j0["user"]["tags"][1] == "c");
+
+    std::vector<json_pointer> rules = { name, tag, json_pointer("/a~1b") };
+    std::cout << color::F_GREEN;
+    for (const auto& rule : rules)
+    {
+        std::cout << rule.to_string() << " = " << j0.at(rule) << "\n";
+    }
+    std::cout << color::CLEAR_F;
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "test.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// counts every allocation, tearing a document down must not make any
+static std::atomic<std::size_t> allocation_count(0);
+
+// out of line, so an inlined malloc is never paired with the library's delete
+#if defined(_MSC_VER)
+#   define TEST_NOINLINE __declspec(noinline)
+#else
+#   define TEST_NOINLINE __attribute__((noinline))
+#endif
+
+TEST_NOINLINE void* operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+TEST_NOINLINE void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+// every form that may free what the ones above allocated
+TEST_NOINLINE void operator delete(void* ptr)noexcept
+{
+    std::free(ptr);
+}
+
+TEST_NOINLINE void operator delete[](void* ptr)noexcept
+{
+    std::free(ptr);
+}
+
+TEST_NOINLINE void operator delete(void* ptr, std::size_t)noexcept
+{
+    std::free(ptr);
+}
+
+TEST_NOINLINE void operator delete[](void* ptr, std::size_t)noexcept
+{
+    std::free(ptr);
+}
+
+json create_deep(int depth)
+{
+    json doc;
+    json* current = &doc;
+    for (int i = 0; i < depth; ++i)
+    {
+        current->push_back(json());
+        current = &(*current)[0];
+    }
+    return doc;
+}
+
+int main()
+{
+    // destroying a deep document does not recurse once per level
+    json deep = create_deep(1000000);
+    deep.clear();
+    JSON_ASSERT(deep.is_null());
+
+    {
+        json wide = json::array({});
+        for (int i = 0; i < 1000; ++i)
+        {
+            wide.push_back(json::object({ "index", json::array({ i, create_deep(100) }) }));
+        }
+    }
+
+    {
+        json mixed = json::parse("[{\"a\": [[1, {}], {\"b\": [[], [2, \"s\"]]}], \"c\": {\"d\": [3]}}, [[[4]]], \"e\", [5]]");
+        mixed.push_back(create_deep(1000));
+        const json shared = mixed[0]["a"];
+        const std::size_t before = allocation_count.load();
+        mixed.clear();
+        JSON_ASSERT(allocation_count.load() == before && shared[1]["b"][1][1] == "s");
+    }
+
+    // hand the document over to the background thread
+    json doc = json::parse("{\"arr\": [1, 2, [3, [4, [5]]]], \"obj\": {\"k\": \"v\"}}");
+    json keep = doc["obj"];
+    doc.clear_async();
+    JSON_ASSERT(doc.is_null());
+
+    json another = create_deep(100000);
+    another.clear_async();
+    sjson::detail::json_release_queue<json>::instance().flush();
+
+    JSON_ASSERT(keep["k"] == "v");
+    std::cout << color::F_GREEN << keep << "\n" << color::CLEAR_F;
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 #include "test.h"
 #include <fstream>
 #include <chrono>
+#include <limits>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
 using namespace std::chrono;
 
 const auto get_now = [](){
@@ -35,6 +39,19 @@ json create_json()
     };
 }
 
+// the same document, every value built in place
+json create_json_builder()
+{
+    return json::make_object(
+        "test", 233,
+        "hello", "world",
+        "is_ok", true,
+        "obj", json::make_object("000", 123),
+        "array", json::make_array(0, 1, 1, 2, 3, 5, 8),
+        "测试", json::make_array(123456789101112, 3.14159265358, true, "ok", "可以", "😀", nullptr)
+    );
+}
+
 
 int main()
 {
@@ -48,6 +65,90 @@ int main()
     std::cout << color::F_GREEN << "create json " << count 
               << " count, time speed " << (t1 - t0).count() << " us\n" << color::CLEAR_F;
 
+    t0 = get_now();
+    for (int i = 0; i < count; ++i)
+    {
+        auto temp = create_json_builder();
+    }
+    t1 = get_now();
+    std::cout << color::F_GREEN << "build json " << count
+              << " count, time speed " << (t1 - t0).count() << " us\n" << color::CLEAR_F;
+    JSON_ASSERT(create_json_builder() == create_json());
+
+    json::array_builder rows(3);
+    for (int i = 0; i < 3; ++i)
+    {
+        rows.emplace_back(json::object_builder().emplace("id", i).emplace("name", "row").build());
+    }
+    JSON_ASSERT(rows.size() == 3 && rows.build().dump() == R"([{"id":0,"name":"row"},{"id":1,"name":"row"},{"id":2,"name":"row"}])");
+
+    // integers of every length, and the bounds of both types
+    const json integers = json::array({ 0, 7, -7, 10, 99, 100, -100, 12345, 1000000007, -9876543210LL,
+        std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max(),
+        std::numeric_limits<unsigned long long>::max() });
+    JSON_ASSERT(integers.dump() == "[0,7,-7,10,99,100,-100,12345,1000000007,-9876543210,"
+        "-9223372036854775808,9223372036854775807,18446744073709551615]");
+    for (long long num = 1; num > 0 && num < std::numeric_limits<long long>::max() / 3; num = num * 3 + 1)
+    {
+        JSON_ASSERT(json(num).dump() == std::to_string(num) && json(-num).dump() == std::to_string(-num));
+    }
+
+    // quotes, backslashes and control characters are escaped wherever they are
+    JSON_ASSERT(json("a\"b\\c\b\f\n\r\t\x01\x1f\x7f").dump() == "\"a\\\"b\\\\c\\b\\f\\n\\r\\t\\u0001\\u001F\x7f\"");
+    for (std::size_t length = 0; length < 100; length += 7)
+    {
+        for (std::size_t pos = 0; pos < length; pos += 3)
+        {
+            std::string text(length, 'x');
+            text[pos] = pos % 2 ? '\n' : '"';
+            const auto dumped = json(text).dump();
+            JSON_ASSERT(dumped.size() == length + 3 && json::parse(dumped) == text);
+        }
+    }
+    const std::string control(32, '\x1e');
+    JSON_ASSERT(json(control).dump().size() == 32 * 6 + 2 && json::parse(json(control).dump()) == control);
+
+    // floats are written with the fewest digits that parse back to the same value
+    const json floats = json::array({ 0.1, 0.1 + 0.2, 1e23, 5e-324, 1.7976931348623157e308, -0.0, 2.0, 1e-5, 123456.789 });
+    JSON_ASSERT(floats.dump() == "[0.1,0.30000000000000004,1e+23,5e-324,1.7976931348623157e+308,-0.0,2,1e-05,123456.789]");
+    JSON_ASSERT(json(std::numeric_limits<double>::quiet_NaN()).dump() == "null");
+    const json negative_zero = json::parse(json(-0.0).dump());
+    JSON_ASSERT(negative_zero.is_float() && std::signbit(negative_zero.get<double>()));
+    for (const double num : { 1.0 / 3, 2.0 / 3, 9007199254740993.0, 4.35, 0.000123456789012345678 })
+    {
+        JSON_ASSERT(std::strtod(json(num).dump().c_str(), nullptr) == num);
+    }
+
+    // and parsed to the nearest double, so text survives a round trip
+    for (const char* text : { "8.95", "0.1", "1e-07", "-2.5e+300", "1.7976931348623157e+308", "3.141592653589793" })
+    {
+        JSON_ASSERT(json::parse(text).dump() == text);
+    }
+    JSON_ASSERT(json::parse("0.30000000000000004441").dump() == "0.30000000000000004");
+    JSON_ASSERT(json::parse("0e+5") == 0.0 && json::parse("1.00000000000000000000000000000000000001e-2").dump() == "0.01");
+
+
+    // dump_to() grows its string once, to the size serialized_size() counts
+    for (const json& doc : { create_json(), floats, integers, json(control), json::parse("[[], {}, [{}], {\"a\": [1, [2, {\"b\": null}]]}]"),
+                            json::parse("[[1, -2, 3], [0.5, 1e+300], [true, false]]") })
+    {
+        for (const unsigned int indent : { 0u, 1u, 4u, 40u })
+        {
+            std::ostringstream oss;
+            oss << std::setw(indent) << doc;
+            std::string out = "prefix";
+            JSON_ASSERT(doc.dump_to(out, indent) == oss.str().size() && out == "prefix" + oss.str());
+            JSON_ASSERT(doc.dump(indent) == oss.str() && doc.serialized_size(indent) == oss.str().size());
+        }
+    }
+
+    const json doc = create_json();
+    const auto text = doc.dump();
+    std::string buffer(text.size() + 8, '#');
+    JSON_ASSERT(doc.dump_to(&buffer[0], buffer.size()) == text.size() && buffer.compare(0, text.size(), text) == 0);
+    JSON_ASSERT(doc.dump_to(&buffer[0], 5) == text.size() && buffer.compare(0, 5, text, 0, 5) == 0);
+    JSON_ASSERT(doc.dump_to(nullptr, 0) == text.size() && json().dump() == "null");
+
 
     json obj = create_json();
 
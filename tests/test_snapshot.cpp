@@ -0,0 +1,72 @@
+#include "test.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// built before the release queue and destroyed after it, so its last version
+// is released once the queue is gone
+static sjson::json_snapshot exit_config(json::parse(R"({"mode": "static", "limits": [1, 2, 3]})"));
+
+int main()
+{
+    JSON_ASSERT((*exit_config.load())["limits"].size() == 3);
+
+    sjson::json_snapshot routes(json::parse(R"({"version": 0, "targets": [0, 0, 0]})"));
+    JSON_ASSERT(routes.version() == 0 && (*routes.load())["version"] == 0);
+
+    // readers always see a whole version, never a half written one
+    std::atomic<bool> done(false);
+    std::atomic<int> reads(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; ++i)
+    {
+        readers.emplace_back([&]()
+        {
+            auto reader = routes.make_reader();
+            int last = 0;
+            do
+            {
+                const json& doc = reader.get();
+                const int version = doc["version"].get<int>();
+                JSON_ASSERT(version >= last);
+                for (const auto& target : doc["targets"])
+                {
+                    JSON_ASSERT(target == version);
+                }
+                JSON_ASSERT((*routes.load())["version"].get<int>() >= version);
+                last = version;
+                reads.fetch_add(1);
+            } while (!done.load());
+        });
+    }
+
+    json working = json::parse(R"({"version": 0, "targets": [0, 0, 0]})");
+    for (int version = 1; version <= 200; ++version)
+    {
+        working["version"] = version;
+        for (auto& target : working["targets"])
+        {
+            target = version;
+        }
+        JSON_ASSERT(routes.publish(working) == static_cast<std::uint64_t>(version));
+    }
+
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    JSON_ASSERT(reads.load() > 0);
+
+    // a pinned version outlives later publishes
+    auto reader = routes.make_reader();
+    const auto pinned = (reader.get(), reader.pin());
+    routes.publish(json::parse(R"({"version": -1})"));
+    JSON_ASSERT((*pinned)["version"] == 200 && reader->at("version") == -1 && reader.version() == 201);
+    JSON_ASSERT(working["version"] == 200);
+
+    sjson::detail::json_release_queue<json>::instance().flush();
+    std::cout << color::F_GREEN << *routes.load() << "\n" << color::CLEAR_F;
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "test.h"
+
+int main()
+{
+    const char* str = "{\"name\": \"tape\", \"nums\": [1, 2.5, -3, [4, 5], {\"six\": 6}], \"ok\": true, \"none\": null}";
+
+    const auto tape = sjson::json_tape::parse(str);
+    const auto root = tape.root();
+
+    JSON_ASSERT(root.is_object() && root.size() == 4);
+    JSON_ASSERT(root["name"].as_string() == "tape");
+    JSON_ASSERT(root["ok"].as_bool() && root["none"].is_null());
+    JSON_ASSERT(!root.contains("missing"));
+
+    const auto nums = root["nums"];
+    JSON_ASSERT(nums.is_array() && nums.size() == 5);
+    JSON_ASSERT(nums[0].as_int() == 1 && nums[1].as_float() == 2.5 && nums[2].as_int() == -3);
+    JSON_ASSERT(nums[3][1].as_int() == 5 && nums[4]["six"].as_int() == 6);
+
+    int count = 0;
+    for (const auto& val : nums)
+    {
+        JSON_ASSERT(val.type() == nums[count].type());
+        ++count;
+    }
+    JSON_ASSERT(count == 5);
+
+    for (auto iter = root.begin(); iter != root.end(); ++iter)
+    {
+        std::cout << color::F_GREEN << iter.key() << color::CLEAR_F << ": "
+                  << color::F_BLUE << iter.value().to_json() << color::CLEAR_F << "\n";
+    }
+
+    const json dom = tape.to_json();
+    JSON_ASSERT(dom == json::parse(str));
+    JSON_ASSERT(sjson::json_tape::from_json(dom).to_json() == dom);
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "test.h"
+#include <sstream>
 
 struct Person
 {
@@ -1,4 +1,5 @@
 #include "test.h"
+#include <unordered_map>
 
 int main()
 {
@@ -27,7 +28,75 @@ int main()
     JSON_ASSERT(nullptr == (std::nullptr_t)j1);
     JSON_ASSERT(double(j2) == -0.1);
     JSON_ASSERT(static_cast<std::string>(j3) == "中文测试");
-    
+
+    // take() and rvalue get() move containers out and leave null
+    json j6 = json::parse("{\"list\": [1, \"two\", 3], \"name\": \"a message too long for the small string buffer\"}");
+    const auto* name_data = j6["name"].as_string().data();
+    const auto name = j6["name"].take<std::string>();
+    JSON_ASSERT(name.size() == 46 && name.data() == name_data && j6["name"].is_null());
+
+    const auto list = std::move(j6["list"]).get<json::array_t>();
+    JSON_ASSERT(list.size() == 3 && list[1] == "two" && j6["list"].is_null());
+    JSON_ASSERT(j6.take<json::object_t>().size() == 2 && j6.is_null());
+
+    json j7 = 7;
+    JSON_ASSERT(j7.take<int>() == 7 && j7.is_null());
+
+    // get_ptr, get_ref and string views do not copy
+    json j8 = json::parse("{\"kind\": \"event\", \"items\": [1, 2]}");
+    JSON_ASSERT(j8["kind"].get_ptr<const std::string*>() == &j8["kind"].as_string());
+    JSON_ASSERT(j8["kind"].get_ptr<json::array_t*>() == nullptr);
+    j8["items"].get_ref<json::array_t&>().push_back(3);
+    JSON_ASSERT(j8["items"].size() == 3);
+    JSON_ASSERT(j8["kind"].as_string_view() == "event" && j8.cbegin().key_view() == "items");
+
+    const json& j9 = j8;
+    JSON_ASSERT(j9.get_ref<const json::object_t&>().size() == 2);
+
+    // keys can be looked up by view without building a key string
+    const sjson::string_view key("kind plus tail", 4);
+    JSON_ASSERT(j9.contains(key) && j9.find(key) != j9.cend() && j9.at(key) == "event");
+    JSON_ASSERT(j9[key] == "event" && j9.find(sjson::string_view("kin")) == j9.cend());
+    j8[sjson::string_view("added")] = 1;
+    JSON_ASSERT(j8.at("added") == 1 && j8.erase(sjson::string_view("added")) == 1 && !j8.contains("added"));
+    JSON_ASSERT(j8.erase(std::string("missing")) == 0 && j8.size() == 2);
+
+    // an object type whose third parameter is not a comparator is looked up
+    // through a built key
+    using hashed_json = sjson::detail::basic_json<std::unordered_map, std::vector, std::string, std::int64_t, double, bool, std::allocator>;
+    hashed_json h0 = hashed_json::parse("{\"kind\": \"event\", \"id\": 7}");
+    const hashed_json& h1 = h0;
+    JSON_ASSERT(h1.contains(key) && h1.at(key) == "event" && h1["id"] == 7 && h1.find(sjson::string_view("kin")) == h1.cend());
+    JSON_ASSERT(h0.erase(sjson::string_view("id")) == 1 && h0.size() == 1);
+
+    // capacity and in place construction
+    json j10;
+    j10.reserve(64);
+    JSON_ASSERT(j10.is_array() && j10.capacity() >= 64 && j10.empty());
+    for (int i = 0; i < 64; ++i)
+    {
+        j10.push_back(i);
+    }
+    JSON_ASSERT(j10.capacity() >= 64 && j10[63] == 63);
+    j10.pop_back();
+    j10.shrink_to_fit();
+    JSON_ASSERT(j10.size() == 63 && j10.capacity() >= 63);
+
+    json& added = j10.emplace_back("text");
+    JSON_ASSERT(added == "text" && j10.size() == 64 && j10[63] == "text");
+    j10[99] = true;
+    JSON_ASSERT(j10.size() == 100 && j10[98].is_null());
+
+    json j11;
+    j11.reserve(2);
+    j11 = json::parse("{}");
+    JSON_ASSERT(j11.emplace("name", "sjson").second && !j11.emplace("name", "other").second);
+    const auto emplaced = j11.emplace(std::string("size"), 3);
+    JSON_ASSERT(emplaced.second && emplaced.first.key() == "size" && emplaced.first.value() == 3);
+    JSON_ASSERT(j11.capacity() >= j11.size() && j11["name"] == "sjson");
+    j11.shrink_to_fit();
+    JSON_ASSERT(j11.size() == 2 && json(1).emplace("k", 1).second == false);
+
 
     std::cout << color::F_GREEN << j4 << "\n" << color::CLEAR_F;
     std::cout << color::F_BLUE << j5 << "\n" << color::CLEAR_F;